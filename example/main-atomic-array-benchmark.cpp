@@ -0,0 +1,182 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <new>
+#include <cstdlib>
+#include <boost/simulation/fixed_time.hpp>
+#include <boost/simulation/pdevs/coordinator.hpp>
+#include <boost/simulation/pdevs/atomic_array.hpp>
+#include <boost/simulation/convenience.hpp>
+
+using namespace boost::simulation;
+using namespace boost::simulation::pdevs;
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+using Time=fixed_time<1000>;
+using Message=int;
+using models=vector<shared_ptr<model<Time>>>;
+using couplings=vector<pair<shared_ptr<model<Time>>, shared_ptr<model<Time>>>>;
+using edges=vector<pair<uint32_t, uint32_t>>;
+
+//This example compares a population of identical agents simulated as atomic models, each one with its
+//own allocation, virtual table and simulator, against the same agents in an atomic_array, keeping
+//their state in columns and running the internal transitions of the imminent ones in a single loop.
+//The agents are pulse models in a grid, each one coupled to its four neighbours. The bytes allocated
+//to build the models and the coordinator, and the time per step of the simulation are reported.
+
+static size_t allocated = 0;
+
+void* operator new(size_t size){
+    allocated += size;
+    if (void* p = malloc(size)) return p;
+    throw bad_alloc{};
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+//emits every period and counts the messages received, the time left to emit is kept on input
+class pulse : public pdevs::atomic<Time, Message>
+{
+    Time _period;
+    Time _left;
+    int _received = 0;
+public:
+    explicit pulse(Time period) noexcept : _period(period), _left(period) {}
+    void internal() noexcept { _left = _period; }
+    Time advance() const noexcept { return _left; }
+    vector<Message> out() const noexcept { return {_received}; }
+    void external(const vector<Message>& mb, const Time& e) noexcept {
+        _left = _left - e;
+        _received += static_cast<int>(mb.size());
+    }
+    void confluence(const vector<Message>& mb, const Time& e) noexcept {
+        internal();
+        _received += static_cast<int>(mb.size());
+    }
+};
+
+//the pulse model in columns
+struct pulse_kernel
+{
+    using time_type=Time;
+    using message_type=Message;
+    vector<Time> period;
+    vector<Time> left;
+    vector<int> received;
+
+    explicit pulse_kernel(const vector<Time>& periods) : period(periods), left(periods), received(periods.size(), 0) {}
+    size_t size() const noexcept { return period.size(); }
+    Time advance(uint32_t i) const noexcept { return left[i]; }
+    void internal(const uint32_t* is, size_t k, Time* ta) noexcept {
+        for (size_t j = 0; j < k; j++){
+            left[is[j]] = period[is[j]];
+            ta[j] = period[is[j]];
+        }
+    }
+    Time external(uint32_t i, const vector<Message>& mb, const Time& e) noexcept {
+        left[i] = left[i] - e;
+        received[i] += static_cast<int>(mb.size());
+        return left[i];
+    }
+    Time confluence(uint32_t i, const vector<Message>& mb) noexcept {
+        left[i] = period[i];
+        received[i] += static_cast<int>(mb.size());
+        return left[i];
+    }
+    void out(uint32_t i, vector<Message>& bag) const noexcept { bag.push_back(received[i]); }
+};
+
+//periods of the agents and the couplings of a side x side grid, neighbours coupled both ways
+vector<Time> periods(size_t side){
+    mt19937 gen(42);
+    vector<Time> ps;
+    for (size_t i = 0; i < side * side; i++) ps.push_back(Time::from_ticks(1 + gen() % 16));
+    return ps;
+}
+
+edges grid(size_t side){
+    edges es;
+    for (uint32_t r = 0; r < side; r++){
+        for (uint32_t c = 0; c < side; c++){
+            uint32_t i = r * side + c;
+            if (c > 0){
+                es.emplace_back(i - 1, i);
+                es.emplace_back(i, i - 1);
+            }
+            if (r > 0){
+                es.emplace_back(i - side, i);
+                es.emplace_back(i, i - side);
+            }
+        }
+    }
+    return es;
+}
+
+shared_ptr<coupled<Time, Message>> with_atomics(size_t side){
+    models ms;
+    for (Time p : periods(side)) ms.push_back(make_atomic_ptr<pulse, Time>(p));
+    couplings ic;
+    for (auto& e : grid(side)) ic.emplace_back(ms[e.first], ms[e.second]);
+    return make_shared<coupled<Time, Message>>(ms, models{}, ic, models{});
+}
+
+shared_ptr<coupled<Time, Message>> with_array(size_t side){
+    auto array = make_atomic_ptr<atomic_array<pulse_kernel>>(pulse_kernel{periods(side)}, vector<uint32_t>{}, grid(side), vector<uint32_t>{});
+    return make_shared<coupled<Time, Message>>(models{array}, models{}, couplings{}, models{});
+}
+
+template<template<class, class> class FEL, class BUILD>
+void run(const char* label, BUILD build, size_t side){
+    size_t before = allocated;
+    auto cm = build(side);
+    coordinator<Time, Message, FEL> c{cm};
+    Time t = c.init(Time{0});
+    double bytes = static_cast<double>(allocated - before) / (side * side);
+    size_t steps = 0;
+    auto start = hclock::now();
+    for (; t < Time::from_ticks(100); t = c.next(), steps++){
+        c.advanceSimulation(t);
+    }
+    double elapsed = chrono::duration_cast<chrono::duration<double, ratio<1>>>(hclock::now() - start).count();
+    cout << "  " << label << bytes << " bytes per agent, " << elapsed * 1e6 / steps << "us per step" << endl;
+}
+
+int main(){
+    for (size_t side : {100, 300, 600}){
+        cout << side * side << " agents in a grid" << endl;
+        run<priority_queue_vector>("atomic models, FEL:     ", with_atomics, side);
+        run<nullqueue>("atomic models, polling: ", with_atomics, side);
+        run<priority_queue_vector>("atomic array:           ", with_array, side);
+    }
+    return 0;
+}
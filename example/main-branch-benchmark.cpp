@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <boost/simulation/fixed_time.hpp>
+#include <boost/simulation/pdevs/branch.hpp>
+#include <boost/simulation/pdevs/basic_models/generator.hpp>
+#include <boost/simulation/pdevs/basic_models/processor.hpp>
+#include <boost/simulation/convenience.hpp>
+
+using namespace boost::simulation;
+using namespace boost::simulation::pdevs;
+using namespace boost::simulation::pdevs::basic_models;
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+using Time=fixed_time<1>;
+using Message=int;
+using models=vector<shared_ptr<model<Time>>>;
+using couplings=vector<pair<shared_ptr<model<Time>>, shared_ptr<model<Time>>>>;
+
+//This example compares two ways of exploring what-if branches from a warm state: simulating each branch
+//from the start, warm-up included, against warming up once and forking a process per branch, sharing the
+//warm state copy-on-write. The model is a set of generators feeding processors, every branch injects a
+//different burst of jobs into the processors after the warm-up and simulates a short horizon.
+
+const Time warm_up{2000};
+const Time horizon{2100};
+const size_t branches = 8;
+
+shared_ptr<coupled<Time, Message>> queues(size_t n){
+    models ms, eic;
+    couplings ic;
+    for (size_t i = 0; i < n; i++){
+        auto g = make_atomic_ptr<generator<Time, Message>>(Time{static_cast<int>(2 + i % 5)}, 1);
+        auto p = make_atomic_ptr<processor<Time, Message>>(Time{1});
+        ms.push_back(g);
+        ms.push_back(p);
+        eic.push_back(p);
+        ic.emplace_back(g, p);
+    }
+    return make_shared<coupled<Time, Message>>(ms, eic, ic, models{});
+}
+
+string what_if(size_t i, runner<Time, Message>& r){
+    r.inject(vector<Message>(i + 1, 2), warm_up);
+    return to_string(r.runUntil(horizon).ticks());
+}
+
+double seconds(hclock::time_point start){
+    return chrono::duration_cast<chrono::duration<double, ratio<1>>>(hclock::now() - start).count();
+}
+
+int main(){
+    for (size_t n : {1000, 10000, 50000}){
+        cout << n << " queues, " << branches << " branches" << endl;
+        auto start = hclock::now();
+        for (size_t i = 0; i < branches; i++){
+            runner<Time, Message> r(queues(n), Time{0});
+            r.runUntil(warm_up);
+            what_if(i, r);
+        }
+        double scratch = seconds(start);
+        start = hclock::now();
+        runner<Time, Message> r(queues(n), Time{0});
+        r.runUntil(warm_up);
+        double warm = seconds(start);
+        start = hclock::now();
+        branch(r, warm_up, branches, what_if, 1);
+        double forked = seconds(start);
+        cout << "  from the start: " << scratch * 1e3 / branches << "ms per branch" << endl;
+        cout << "  forked:         " << forked * 1e3 / branches << "ms per branch, after a warm-up of " << warm * 1e3 << "ms" << endl;
+    }
+    return 0;
+}
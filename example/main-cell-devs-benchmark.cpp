@@ -0,0 +1,155 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <new>
+#include <cstdlib>
+#include <boost/simulation/fixed_time.hpp>
+#include <boost/simulation/pdevs/coordinator.hpp>
+#include <boost/simulation/pdevs/cell_devs.hpp>
+#include <boost/simulation/convenience.hpp>
+
+using namespace boost::simulation;
+using namespace boost::simulation::pdevs;
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+using Time=fixed_time<1000>;
+using Message=int;
+using models=vector<shared_ptr<model<Time>>>;
+using couplings=vector<pair<shared_ptr<model<Time>>, shared_ptr<model<Time>>>>;
+
+//This example compares two ways of simulating a fire spreading from the center of a square grid,
+//each cell igniting one time unit after one of its eight neighbors burns: atomic models coupled to
+//their neighbors in a coupled model, and a Cell-DEVS cell_space. The bytes allocated to build the
+//models and the coordinator, the time to build and init them and the time to run until the fire
+//ends are reported.
+
+static size_t allocated = 0;
+
+void* operator new(size_t size){
+    allocated += size;
+    if (void* p = malloc(size)) return p;
+    throw bad_alloc{};
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+//ignites one time unit after receiving fire, and sends fire to its neighbors
+class fire_cell : public pdevs::atomic<Time, Message>
+{
+    bool _burning = false;
+    Time _sigma;
+public:
+    explicit fire_cell(bool ignited) noexcept : _sigma(ignited ? Time(1) : Time::Inf()) {}
+    void internal() noexcept {
+        _burning = true;
+        _sigma = Time::Inf();
+    }
+    Time advance() const noexcept { return _sigma; }
+    vector<Message> out() const noexcept { return {1}; }
+    void external(const vector<Message>&, const Time& e) noexcept {
+        if (_burning) return;
+        _sigma = (_sigma == Time::Inf() ? Time(1) : _sigma - e);
+    }
+    void confluence(const vector<Message>& mb, const Time&) noexcept {
+        internal();
+    }
+};
+
+//the same rule for a cell_space, 0 unburnt, 1 burning
+struct fire_rule
+{
+    using time_type=Time;
+    using message_type=Message;
+    using state_type=int;
+    int local(uint32_t, const neighborhood<int>& n) const noexcept {
+        for (int s : n){
+            if (s == 1) return 1;
+        }
+        return 0;
+    }
+    pair<uint32_t, int> in(const Message& m) const noexcept { return {static_cast<uint32_t>(m), 1}; }
+    Message out(uint32_t, const int& s) const noexcept { return s; }
+};
+
+shared_ptr<coupled<Time, Message>> with_atomics(size_t side){
+    models ms;
+    for (size_t i = 0; i < side * side; i++) ms.push_back(make_atomic_ptr<fire_cell>(i == (side / 2) * side + side / 2));
+    couplings ic;
+    for (long r = 0; r < static_cast<long>(side); r++){
+        for (long c = 0; c < static_cast<long>(side); c++){
+            for (long dr = -1; dr <= 1; dr++){
+                for (long dc = -1; dc <= 1; dc++){
+                    long nr = r + dr, nc = c + dc;
+                    if ((dr == 0 && dc == 0) || nr < 0 || nc < 0 || nr >= static_cast<long>(side) || nc >= static_cast<long>(side)) continue;
+                    ic.emplace_back(ms[r * side + c], ms[nr * side + nc]);
+                }
+            }
+        }
+    }
+    return make_shared<coupled<Time, Message>>(ms, models{}, ic, models{});
+}
+
+shared_ptr<coupled<Time, Message>> with_cell_space(size_t side){
+    //the center cell is burning from the start, so its neighbors ignite at time 1 as the atomic models
+    vector<int> initial(side * side, 0);
+    initial[(side / 2) * side + side / 2] = 1;
+    auto space = make_atomic_ptr<cell_space<fire_rule>>(fire_rule{}, vector<size_t>{side, side}, moore(2), initial, Time(1), vector<uint32_t>{}, 0);
+    return make_shared<coupled<Time, Message>>(models{space}, models{}, couplings{}, models{});
+}
+
+template<class BUILD>
+void run(const char* label, BUILD build, size_t side){
+    size_t before = allocated;
+    auto start = hclock::now();
+    auto cm = build(side);
+    coordinator<Time, Message, priority_queue_vector> c{cm};
+    Time t = c.init(Time{0});
+    double startup = chrono::duration_cast<chrono::duration<double, ratio<1>>>(hclock::now() - start).count();
+    double bytes = static_cast<double>(allocated - before) / (side * side);
+    start = hclock::now();
+    size_t steps = 0;
+    for (; t != Time::Inf(); t = c.next(), steps++){
+        c.advanceSimulation(t);
+    }
+    double elapsed = chrono::duration_cast<chrono::duration<double, ratio<1>>>(hclock::now() - start).count();
+    cout << "  " << label << bytes << " bytes per cell, " << startup * 1e3 << "ms to start, "
+         << elapsed * 1e3 << "ms to run " << steps << " steps" << endl;
+}
+
+int main(){
+    for (size_t side : {100, 300, 600}){
+        cout << side * side << " cells" << endl;
+        run("coupled atomic models: ", with_atomics, side);
+        run("cell space:            ", with_cell_space, side);
+    }
+    return 0;
+}
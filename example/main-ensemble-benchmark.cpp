@@ -0,0 +1,175 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <boost/simulation/fixed_time.hpp>
+#include <boost/simulation/pdevs/coordinator.hpp>
+#include <boost/simulation/pdevs/ensemble.hpp>
+#include <boost/simulation/convenience.hpp>
+
+using namespace boost::simulation;
+using namespace boost::simulation::pdevs;
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+using Time=fixed_time<1>;
+using Message=int;
+using models=vector<shared_ptr<model<Time>>>;
+using couplings=vector<pair<shared_ptr<model<Time>>, shared_ptr<model<Time>>>>;
+
+//This example compares the replications per second of a small stochastic model, a source sending jobs
+//to a server, run as separate replications of atomic models and as the lanes of an ensemble.
+//Times are integer ticks drawn uniformly from [1, 4 x scale] between jobs and [1, 3 x scale] for service.
+//With scale 1 the lanes have most of their events at the same times and the ensemble runs them in
+//lockstep, with larger scales the lanes diverge and each step runs few of them.
+
+//xorshift32, uniform in [1, most]
+Time draw(uint32_t& x, uint32_t most){
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return Time(static_cast<long long>(1 + x % most));
+}
+
+class source : public pdevs::atomic<Time, Message>
+{
+    uint32_t _rng;
+    uint32_t _most;
+    Time _sigma;
+public:
+    source(uint32_t seed, uint32_t scale) noexcept : _rng(seed), _most(4 * scale) { _sigma = draw(_rng, _most); }
+    void internal() noexcept { _sigma = draw(_rng, _most); }
+    Time advance() const noexcept { return _sigma; }
+    vector<Message> out() const noexcept { return {1}; }
+    void external(const vector<Message>&, const Time&) noexcept {}
+    void confluence(const vector<Message>&, const Time&) noexcept { internal(); }
+};
+
+class server : public pdevs::atomic<Time, Message>
+{
+    uint32_t _rng;
+    uint32_t _most;
+    Time _sigma = Time::Inf();
+    int _queued = 0;
+public:
+    int served = 0;
+    server(uint32_t seed, uint32_t scale) noexcept : _rng(seed ^ 0x9e3779b9u), _most(3 * scale) {}
+    void internal() noexcept {
+        served++;
+        _queued--;
+        _sigma = (_queued > 0 ? draw(_rng, _most) : Time::Inf());
+    }
+    Time advance() const noexcept { return _sigma; }
+    vector<Message> out() const noexcept { return {1}; }
+    void external(const vector<Message>& mb, const Time& e) noexcept {
+        bool idle = (_queued == 0);
+        _queued += static_cast<int>(mb.size());
+        _sigma = (idle ? draw(_rng, _most) : _sigma - e);
+    }
+    void confluence(const vector<Message>& mb, const Time&) noexcept {
+        internal();
+        external(mb, Time(0));
+    }
+};
+
+//the source and the server in columns, element 0 is the source and 1 the server, lanes interleaved
+struct queue_kernel
+{
+    using time_type=Time;
+    using message_type=Message;
+    size_t lanes;
+    uint32_t scale;
+    vector<uint32_t> rng;
+    vector<Time> sigma;
+    vector<int> queued, served;
+
+    queue_kernel(size_t k, uint32_t s) : lanes(k), scale(s), rng(2 * k), sigma(2 * k, Time::Inf()), queued(2 * k, 0), served(2 * k, 0) {
+        for (size_t l = 0; l < k; l++){
+            rng[l] = static_cast<uint32_t>(1 + l);
+            rng[k + l] = static_cast<uint32_t>(1 + l) ^ 0x9e3779b9u;
+            sigma[l] = draw(rng[l], 4 * scale);
+        }
+    }
+    Time next_event(uint32_t i) noexcept {
+        if (i < lanes) return sigma[i] = draw(rng[i], 4 * scale);
+        served[i]++;
+        queued[i]--;
+        return sigma[i] = (queued[i] > 0 ? draw(rng[i], 3 * scale) : Time::Inf());
+    }
+    size_t size() const noexcept { return 2 * lanes; }
+    Time advance(uint32_t i) const noexcept { return sigma[i]; }
+    void internal(const uint32_t* is, size_t k, Time* ta) noexcept {
+        for (size_t j = 0; j < k; j++) ta[j] = next_event(is[j]);
+    }
+    Time external(uint32_t i, const vector<Message>& mb, const Time& e) noexcept {
+        bool idle = (queued[i] == 0);
+        queued[i] += static_cast<int>(mb.size());
+        return sigma[i] = (idle ? draw(rng[i], 3 * scale) : sigma[i] - e);
+    }
+    Time confluence(uint32_t i, const vector<Message>& mb) noexcept {
+        next_event(i);
+        return external(i, mb, Time(0));
+    }
+    void out(uint32_t i, vector<Message>& bag) const noexcept { bag.push_back(1); }
+};
+
+template<class BUILD>
+void simulate(BUILD build, Time end){
+    coordinator<Time, Message, priority_queue_vector> c{build()};
+    for (Time t = c.init(Time(0)); t <= end; t = c.next()) c.advanceSimulation(t);
+}
+
+void run(size_t lanes, uint32_t scale){
+    Time end(static_cast<long long>(10000) * scale);
+    auto start = hclock::now();
+    for (size_t l = 0; l < lanes; l++){
+        simulate([l, scale](){
+            auto so = make_atomic_ptr<source>(static_cast<uint32_t>(1 + l), scale);
+            auto se = make_atomic_ptr<server>(static_cast<uint32_t>(1 + l), scale);
+            return make_shared<coupled<Time, Message>>(models{so, se}, models{}, couplings{{so, se}}, models{});
+        }, end);
+    }
+    double separate = chrono::duration_cast<chrono::duration<double, ratio<1>>>(hclock::now() - start).count();
+    start = hclock::now();
+    simulate([lanes, scale](){
+        auto e = make_atomic_ptr<ensemble<queue_kernel>>(queue_kernel{lanes, scale}, lanes, vector<uint32_t>{},
+                                                         vector<pair<uint32_t, uint32_t>>{{0, 1}}, vector<uint32_t>{});
+        return make_shared<coupled<Time, Message>>(models{e}, models{}, couplings{}, models{});
+    }, end);
+    double together = chrono::duration_cast<chrono::duration<double, ratio<1>>>(hclock::now() - start).count();
+    cout << "  " << lanes << " lanes: separate " << lanes / separate << ", ensemble " << lanes / together << " replications per second" << endl;
+}
+
+int main(){
+    for (uint32_t scale : {1, 1000}){
+        cout << "scale " << scale << endl;
+        for (size_t lanes : {8, 64, 512}) run(lanes, scale);
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <boost/simulation/fixed_time.hpp>
+#include <boost/simulation/pdevs/runner.hpp>
+#include <boost/simulation/pdevs/fel/timing_wheel.hpp>
+#include <boost/simulation/pdevs/fel/calendar_queue.hpp>
+#include <boost/simulation/pdevs/fel/adaptive_queue.hpp>
+#include <boost/simulation/pdevs/basic_models/generator.hpp>
+#include <boost/simulation/convenience.hpp>
+
+using namespace boost::simulation;
+using namespace boost::simulation::pdevs;
+using namespace boost::simulation::pdevs::basic_models;
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+using Time=fixed_time<1000>;
+using Message=int;
+
+//This example compares the FEL structures in a model with many generators polling with short periods,
+//like sensors do. Each run builds the same model and simulates it with a silent runner.
+
+shared_ptr<coupled<Time, Message>> sensors(size_t n){
+    vector<shared_ptr<model<Time>>> models;
+    for (size_t i = 0; i < n; i++){
+        Time period = Time::from_ticks(1 + (i * 37) % 97); //between 1 and 97 milliseconds
+        models.push_back(make_atomic_ptr<generator<Time, Message>, Time, Message>(period, i));
+    }
+    return make_shared<coupled<Time, Message>>(models, vector<shared_ptr<model<Time>>>{},
+                                               vector<pair<shared_ptr<model<Time>>, shared_ptr<model<Time>>>>{}, models);
+}
+
+template<template<class, class> class FEL>
+double simulate(size_t n, const Time& end_time){
+    auto start = hclock::now();
+    runner<Time, Message, FEL> r(sensors(n), Time{0});
+    r.runUntil(end_time);
+    return chrono::duration_cast<chrono::duration<double, ratio<1>>>(hclock::now() - start).count();
+}
+
+int main(){
+    const Time end_time{10};
+    for (size_t n : {100, 1000, 10000}){
+        cout << n << " generators until time " << end_time << endl;
+        cout << "  priority_queue_vector: " << simulate<priority_queue_vector>(n, end_time) << "sec" << endl;
+        cout << "  timing_wheel:          " << simulate<timing_wheel>(n, end_time) << "sec" << endl;
+        cout << "  calendar_queue:        " << simulate<calendar_queue>(n, end_time) << "sec" << endl;
+        cout << "  adaptive_queue:        " << simulate<adaptive_queue>(n, end_time) << "sec" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#include <iostream>
+#include <vector>
+#include <new>
+#include <cstdlib>
+#include <boost/simulation/fixed_time.hpp>
+#include <boost/simulation/pdevs/coordinator.hpp>
+#include <boost/simulation/pdevs/basic_models/generator.hpp>
+#include <boost/simulation/pdevs/basic_models/processor.hpp>
+#include <boost/simulation/convenience.hpp>
+
+using namespace boost::simulation;
+using namespace boost::simulation::pdevs;
+using namespace boost::simulation::pdevs::basic_models;
+using namespace std;
+
+using Time=fixed_time<1000>;
+using Message=int;
+using models=vector<shared_ptr<model<Time>>>;
+using couplings=vector<pair<shared_ptr<model<Time>>, shared_ptr<model<Time>>>>;
+
+//This example reports the memory used by the coordinators to simulate each atomic model.
+//The bytes allocated while constructing and initializing the coordinator of a ring of generators
+//are counted by replacing the global operator new, the models are created before counting.
+//Leaf simulators are small nodes stored contiguously in the coordinator of their level,
+//so the bytes per model should stay close to the size of a simulator plus its routes.
+//The bytes allocated by the models themselves are reported for homogeneous populations,
+//with each model owning its parameters and with all of them sharing the same parameters.
+
+static size_t allocated = 0;
+
+void* operator new(size_t size){
+    allocated += size;
+    if (void* p = malloc(size)) return p;
+    throw bad_alloc{};
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+//a single coupled model with n generators connected in a ring
+shared_ptr<coupled<Time, Message>> ring(size_t n){
+    models ms;
+    couplings ic;
+    for (size_t i = 0; i < n; i++){
+        ms.push_back(make_atomic_ptr<generator<Time, Message>, Time, Message>(Time::from_ticks(1 + i % 97), i));
+        if (i > 0) ic.emplace_back(ms[i - 1], ms[i]);
+    }
+    ic.emplace_back(ms.back(), ms.front());
+    return make_shared<coupled<Time, Message>>(ms, models{ms.front()}, ic, models{ms.back()});
+}
+
+//groups of 1000 generators in a ring, groups chained in the upper level
+shared_ptr<coupled<Time, Message>> chained_groups(size_t n){
+    models groups;
+    couplings ic;
+    for (size_t g = 0; g < n / 1000; g++){
+        groups.push_back(ring(1000));
+        if (g > 0) ic.emplace_back(groups[g - 1], groups[g]);
+    }
+    return make_shared<coupled<Time, Message>>(groups, models{groups.front()}, ic, models{groups.back()});
+}
+
+template<template<class, class> class FEL, class BUILD>
+double bytes_per_model(BUILD build, size_t n){
+    auto cm = build(n);
+    size_t before = allocated;
+    coordinator<Time, Message, FEL> c{cm};
+    c.init(Time{0});
+    return static_cast<double>(allocated - before) / n;
+}
+
+template<class MAKE>
+double bytes_per_instance(MAKE make, size_t n){
+    vector<shared_ptr<pdevs::atomic<Time, Message>>> ms;
+    ms.reserve(n);
+    size_t before = allocated;
+    for (size_t i = 0; i < n; i++){
+        ms.push_back(make());
+    }
+    return static_cast<double>(allocated - before) / n;
+}
+
+int main(){
+    using pq_coordinator=coordinator<Time, Message, priority_queue_vector>;
+    using nq_coordinator=coordinator<Time, Message, nullqueue>;
+    cout << "sizeof simulator:                   " << sizeof(simulator<Time, Message, pq_coordinator, null_observer>) << " bytes" << endl;
+    cout << "sizeof coordinator, FEL:            " << sizeof(pq_coordinator) << " bytes" << endl;
+    cout << "sizeof coordinator, polling:        " << sizeof(nq_coordinator) << " bytes" << endl;
+    using shared_generator=generator<Time, Message, shared_parameters>;
+    using shared_processor=processor<Time, Message, shared_parameters>;
+    auto period = make_parameters_ptr<shared_generator>(Time{1}, vector<Message>{1});
+    auto processing = make_parameters_ptr<shared_processor>(Time{1});
+    cout << "generator, own parameters:          " << bytes_per_instance([]{ return make_atomic_ptr<generator<Time, Message>, Time, Message>(Time{1}, 1); }, 100000) << " bytes per instance" << endl;
+    cout << "generator, shared parameters:       " << bytes_per_instance([&]{ return make_atomic_ptr<shared_generator>(period); }, 100000) << " bytes per instance" << endl;
+    cout << "processor, own parameters:          " << bytes_per_instance([]{ return make_atomic_ptr<processor<Time, Message>, Time>(Time{1}); }, 100000) << " bytes per instance" << endl;
+    cout << "processor, shared parameters:       " << bytes_per_instance([&]{ return make_atomic_ptr<shared_processor>(processing); }, 100000) << " bytes per instance" << endl;
+    for (size_t n : {10000, 100000}){
+        cout << n << " models" << endl;
+        cout << "  single level ring, FEL:           " << bytes_per_model<priority_queue_vector>(ring, n) << " bytes per model" << endl;
+        cout << "  single level ring, polling:       " << bytes_per_model<nullqueue>(ring, n) << " bytes per model" << endl;
+        cout << "  chained groups of 1000, FEL:      " << bytes_per_model<priority_queue_vector>(chained_groups, n) << " bytes per model" << endl;
+        cout << "  chained groups of 1000, polling:  " << bytes_per_model<nullqueue>(chained_groups, n) << " bytes per model" << endl;
+    }
+    return 0;
+}
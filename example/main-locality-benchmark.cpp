@@ -0,0 +1,176 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include <boost/simulation/fixed_time.hpp>
+#include <boost/simulation/pdevs/coordinator.hpp>
+#include <boost/simulation/convenience.hpp>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+using namespace boost::simulation;
+using namespace boost::simulation::pdevs;
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+using Time=fixed_time<1000>;
+using Message=int;
+using models=vector<shared_ptr<model<Time>>>;
+using couplings=vector<pair<shared_ptr<model<Time>>, shared_ptr<model<Time>>>>;
+
+//This example measures the effect of storing the simulators by locality in the coupling graph.
+//The topology is a grid of pulse models, each one coupled to its four neighbours, with the models
+//listed in random order in the description, as a generated or imported topology could be.
+//The same simulation is run by coordinators storing simulators in description order and by ones
+//reordering them with reverse Cuthill-McKee, using a FEL and polling the models. The time per step is reported and, when the
+//hardware counters are readable (Linux perf events), the cache misses of each run.
+
+//emits every period and counts the messages received, the time left to emit is kept on input
+class pulse : public pdevs::atomic<Time, Message>
+{
+    Time _period;
+    Time _left;
+    int _received = 0;
+public:
+    explicit pulse(Time period) noexcept : _period(period), _left(period) {}
+    void internal() noexcept { _left = _period; }
+    Time advance() const noexcept { return _left; }
+    vector<Message> out() const noexcept { return {_received}; }
+    void external(const vector<Message>& mb, const Time& e) noexcept {
+        _left = _left - e;
+        _received += static_cast<int>(mb.size());
+    }
+    void confluence(const vector<Message>& mb, const Time& e) noexcept {
+        internal();
+        _received += static_cast<int>(mb.size());
+    }
+};
+
+//a side x side grid, neighbours coupled both ways, the models shuffled in the description
+shared_ptr<coupled<Time, Message>> shuffled_grid(size_t side){
+    mt19937 gen(42);
+    vector<shared_ptr<model<Time>>> grid;
+    for (size_t i = 0; i < side * side; i++){
+        grid.push_back(make_atomic_ptr<pulse, Time>(Time::from_ticks(1 + gen() % 16)));
+    }
+    couplings ic;
+    for (size_t r = 0; r < side; r++){
+        for (size_t c = 0; c < side; c++){
+            if (c > 0){
+                ic.emplace_back(grid[r * side + c - 1], grid[r * side + c]);
+                ic.emplace_back(grid[r * side + c], grid[r * side + c - 1]);
+            }
+            if (r > 0){
+                ic.emplace_back(grid[(r - 1) * side + c], grid[r * side + c]);
+                ic.emplace_back(grid[r * side + c], grid[(r - 1) * side + c]);
+            }
+        }
+    }
+    models ms(grid.begin(), grid.end());
+    shuffle(ms.begin(), ms.end(), gen);
+    return make_shared<coupled<Time, Message>>(ms, models{}, ic, models{});
+}
+
+//counts the cache misses of this thread, not available if the counter can not be opened
+struct cache_misses
+{
+    int fd = -1;
+    cache_misses(){
+#ifdef __linux__
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    ~cache_misses(){
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+    bool available() const { return fd >= 0; }
+    void start(){
+#ifdef __linux__
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+    long long stop(){
+        long long count = 0;
+#ifdef __linux__
+        if (fd < 0) return 0;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+        return count;
+    }
+};
+
+template<template<class, class> class FEL>
+void run(const char* label, size_t side, bool reorder){
+    coordinator<Time, Message, FEL> c{shuffled_grid(side), 1, false, reorder};
+    Time t = c.init(Time{0});
+    cache_misses misses;
+    size_t steps = 0;
+    misses.start();
+    auto start = hclock::now();
+    for (; t < Time::from_ticks(100); t = c.next(), steps++){
+        c.advanceSimulation(t);
+    }
+    double elapsed = chrono::duration_cast<chrono::duration<double, ratio<1>>>(hclock::now() - start).count();
+    long long count = misses.stop();
+    cout << "  " << label << elapsed * 1e6 / steps << "us per step";
+    if (misses.available()) cout << ", " << static_cast<double>(count) / steps << " cache misses per step";
+    cout << endl;
+}
+
+int main(){
+    for (size_t side : {100, 300, 600}){
+        cout << side * side << " models in a shuffled grid" << endl;
+        run<priority_queue_vector>("FEL, description order:     ", side, false);
+        run<priority_queue_vector>("FEL, reordered:             ", side, true);
+        run<nullqueue>("polling, description order: ", side, false);
+        run<nullqueue>("polling, reordered:         ", side, true);
+    }
+    return 0;
+}
@@ -0,0 +1,196 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <cstdio>
+#include <boost/simulation/fixed_time.hpp>
+#include <boost/simulation/pdevs/coordinator.hpp>
+#include <boost/simulation/pdevs/compiled_graph.hpp>
+#include <boost/simulation/pdevs/prototype.hpp>
+#include <boost/simulation/pdevs/basic_models/generator.hpp>
+#include <boost/simulation/pdevs/basic_models/processor.hpp>
+#include <boost/simulation/convenience.hpp>
+
+using namespace boost::simulation;
+using namespace boost::simulation::pdevs;
+using namespace boost::simulation::pdevs::basic_models;
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+using Time=fixed_time<1000>;
+using Message=int;
+using models=vector<shared_ptr<model<Time>>>;
+using couplings=vector<pair<shared_ptr<model<Time>>, shared_ptr<model<Time>>>>;
+
+//This example measures the time to construct and initialize the coordinators of large topologies.
+//Construction is expected to grow linearly with the number of models and couplings,
+//so the time per model should stay flat as the topologies grow.
+//The hierarchical topology is also built and initialized using every hardware thread,
+//the groups are independent subtrees and are processed concurrently.
+//Finally, the hierarchical topology is flattened and saved as a compiled graph, and
+//the startup is measured from mapping the file, binding new generators and coordinating them.
+//Groups of processors starting passive are built on demand by a lazy coordinator.
+//The last four measures include creating the models: groups built one by one are compared
+//with groups copied from a prototype group, whose couplings were resolved once. Then each group
+//is run by a coordinator of its own, as replications are, and the coordinators built one by one are
+//compared with the ones copied from the coordinator of the prototype.
+
+//a single coupled model with n generators connected in a ring
+shared_ptr<coupled<Time, Message>> ring(size_t n){
+    models ms;
+    couplings ic;
+    for (size_t i = 0; i < n; i++){
+        ms.push_back(make_atomic_ptr<generator<Time, Message>, Time, Message>(Time::from_ticks(1 + i % 97), i));
+        if (i > 0) ic.emplace_back(ms[i - 1], ms[i]);
+    }
+    ic.emplace_back(ms.back(), ms.front());
+    return make_shared<coupled<Time, Message>>(ms, models{ms.front()}, ic, models{ms.back()});
+}
+
+//groups of 1000 generators in a chain, groups chained in the upper level
+shared_ptr<coupled<Time, Message>> chained_groups(size_t n){
+    models groups;
+    couplings ic;
+    for (size_t g = 0; g < n / 1000; g++){
+        groups.push_back(ring(1000));
+        if (g > 0) ic.emplace_back(groups[g - 1], groups[g]);
+    }
+    return make_shared<coupled<Time, Message>>(groups, models{groups.front()}, ic, models{groups.back()});
+}
+
+//a generator feeding a chain of groups of 1000 processors, the processors start passive
+shared_ptr<coupled<Time, Message>> passive_groups(size_t n){
+    models groups;
+    couplings ic;
+    groups.push_back(make_atomic_ptr<generator<Time, Message>, Time, Message>(Time::from_ticks(1000), 1));
+    for (size_t g = 0; g < n / 1000; g++){
+        models ms;
+        couplings gic;
+        for (size_t i = 0; i < 1000; i++){
+            ms.push_back(make_atomic_ptr<processor<Time, Message>, Time>(Time::from_ticks(1)));
+            if (i > 0) gic.emplace_back(ms[i - 1], ms[i]);
+        }
+        groups.push_back(make_shared<coupled<Time, Message>>(ms, models{ms.front()}, gic, models{ms.back()}));
+        ic.emplace_back(groups[g], groups[g + 1]);
+    }
+    return make_shared<coupled<Time, Message>>(groups, models{}, ic, models{groups.back()});
+}
+
+template<class BUILD>
+double construct(BUILD build, size_t n, unsigned threads=1, bool lazy=false){
+    auto cm = build(n);
+    auto start = hclock::now();
+    coordinator<Time, Message, priority_queue_vector> c{cm, threads, lazy};
+    c.init(Time{0}, threads);
+    return chrono::duration_cast<chrono::duration<double, ratio<1>>>(hclock::now() - start).count();
+}
+
+double construct_from_compiled_graph(size_t n){
+    const char* path = "startup-benchmark.graph";
+    {
+        auto cm = chained_groups(n);
+        flattened_coupled<Time, Message> flat{models{cm}, models{cm}, couplings{}, models{cm}};
+        //the saved tag of each generator is its position in the group
+        compiled_graph::save(flat, path, [](size_t i, const shared_ptr<model<Time>>&){ return static_cast<uint64_t>(i % 1000); });
+    }
+    //the models are created before starting the clock, as in the other measures
+    vector<shared_ptr<pdevs::atomic<Time, Message>>> generators;
+    for (size_t i = 0; i < n; i++){
+        generators.push_back(make_atomic_ptr<generator<Time, Message>, Time, Message>(Time::from_ticks(1 + i % 1000 % 97), i % 1000));
+    }
+    auto start = hclock::now();
+    compiled_graph graph{path};
+    coordinator<Time, Message, priority_queue_vector> c{std::move(graph).bind<Time, Message>([&generators](size_t i, uint64_t){ return generators[i]; })};
+    c.init(Time{0});
+    double elapsed = chrono::duration_cast<chrono::duration<double, ratio<1>>>(hclock::now() - start).count();
+    remove(path);
+    return elapsed;
+}
+
+double instantiate_one_by_one(size_t n){
+    auto start = hclock::now();
+    coordinator<Time, Message, priority_queue_vector> c{chained_groups(n)};
+    return chrono::duration_cast<chrono::duration<double, ratio<1>>>(hclock::now() - start).count();
+}
+
+double instantiate_from_prototype(size_t n){
+    prototype<Time, Message> group{ring(1000)};
+    auto start = hclock::now();
+    auto instances = group.instantiate(n / 1000);
+    models groups(instances.begin(), instances.end());
+    couplings ic;
+    for (size_t g = 1; g < groups.size(); g++) ic.emplace_back(groups[g - 1], groups[g]);
+    coordinator<Time, Message, priority_queue_vector> c{make_shared<coupled<Time, Message>>(groups, models{groups.front()}, ic, models{groups.back()})};
+    return chrono::duration_cast<chrono::duration<double, ratio<1>>>(hclock::now() - start).count();
+}
+
+//independent groups, each coordinated on its own
+double coordinate_one_by_one(size_t n){
+    auto start = hclock::now();
+    vector<unique_ptr<coordinator<Time, Message, priority_queue_vector>>> cs;
+    for (size_t g = 0; g < n / 1000; g++) cs.emplace_back(new coordinator<Time, Message, priority_queue_vector>{ring(1000)});
+    return chrono::duration_cast<chrono::duration<double, ratio<1>>>(hclock::now() - start).count();
+}
+
+double coordinate_from_prototype(size_t n){
+    prototype<Time, Message, coordinator<Time, Message, priority_queue_vector>> group{ring(1000)};
+    auto start = hclock::now();
+    vector<unique_ptr<coordinator<Time, Message, priority_queue_vector>>> cs;
+    for (size_t g = 0; g < n / 1000; g++) cs.push_back(group.coordinate(group.instantiate()));
+    return chrono::duration_cast<chrono::duration<double, ratio<1>>>(hclock::now() - start).count();
+}
+
+int main(){
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    for (size_t n : {10000, 100000, 1000000}){
+        cout << n << " models" << endl;
+        double flat = construct(ring, n);
+        cout << "  single level ring:      " << flat << "sec, " << flat * 1e9 / n << "ns per model" << endl;
+        double hierarchical = construct(chained_groups, n);
+        cout << "  chained groups of 1000: " << hierarchical << "sec, " << hierarchical * 1e9 / n << "ns per model" << endl;
+        double parallel = construct(chained_groups, n, threads);
+        cout << "  same, " << threads << " threads:      " << parallel << "sec, " << parallel * 1e9 / n << "ns per model" << endl;
+        double compiled = construct_from_compiled_graph(n);
+        cout << "  from compiled graph:    " << compiled << "sec, " << compiled * 1e9 / n << "ns per model" << endl;
+        double eager = construct(passive_groups, n);
+        cout << "  passive groups:         " << eager << "sec, " << eager * 1e9 / n << "ns per model" << endl;
+        double lazy = construct(passive_groups, n, 1, true);
+        cout << "  same, built lazily:     " << lazy << "sec, " << lazy * 1e9 / n << "ns per model" << endl;
+        double one_by_one = instantiate_one_by_one(n);
+        cout << "  models built one by one: " << one_by_one << "sec, " << one_by_one * 1e9 / n << "ns per model" << endl;
+        double cloned = instantiate_from_prototype(n);
+        cout << "  models from prototype:   " << cloned << "sec, " << cloned * 1e9 / n << "ns per model" << endl;
+        double coordinated = coordinate_one_by_one(n);
+        cout << "  groups coordinated one by one: " << coordinated << "sec, " << coordinated * 1e9 / n << "ns per model" << endl;
+        double copied = coordinate_from_prototype(n);
+        cout << "  coordinators from prototype:   " << copied << "sec, " << copied * 1e9 / n << "ns per model" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <boost/rational.hpp>
+#include <boost/simulation/fixed_time.hpp>
+
+using namespace boost::simulation;
+using namespace std;
+
+using hclock=chrono::high_resolution_clock;
+
+//This example compares the time representations in the operations coordinators do the most:
+//computing next = last + advance, finding the minimum next and checking t == next for imminence.
+//A set of periodic models is scheduled by polling, the same way the nullqueue coordinator does.
+
+template<class TIME>
+double schedule(const vector<TIME>& periods, const TIME& end_time, size_t& transitions){
+    vector<TIME> next(periods);
+    TIME t = periods[0];
+    transitions = 0;
+    auto start = hclock::now();
+    while (t < end_time){
+        //transitions of the imminents
+        for (size_t i = 0; i < next.size(); i++){
+            if (next[i] == t){
+                next[i] = t + periods[i];
+                transitions++;
+            }
+        }
+        //selection of next time
+        t = next[0];
+        for (size_t i = 1; i < next.size(); i++){
+            if (next[i] < t) t = next[i];
+        }
+    }
+    return chrono::duration_cast<chrono::duration<double, ratio<1>>>(hclock::now() - start).count();
+}
+
+int main(){
+    const size_t models = 100;
+    const long long end = 100000;
+    cout << "Scheduling " << models << " periodic models until time " << end << endl;
+
+    //periods are multiples of 1/8, exact for all representations
+    vector<double> pd;
+    vector<boost::rational<long long>> pr;
+    vector<fixed_time<1000>> pf;
+    for (size_t i = 0; i < models; i++){
+        long long eighths = 4 + (i * 7) % 29;
+        pd.push_back(eighths / 8.0);
+        pr.push_back(boost::rational<long long>{eighths, 8});
+        pf.push_back(fixed_time<1000>::from_ticks(eighths * 125));
+    }
+
+    size_t transitions;
+    double elapsed = schedule(pd, double(end), transitions);
+    cout << "double:            " << elapsed << "sec for " << transitions << " transitions" << endl;
+    elapsed = schedule(pr, boost::rational<long long>{end}, transitions);
+    cout << "boost::rational:   " << elapsed << "sec for " << transitions << " transitions" << endl;
+    elapsed = schedule(pf, fixed_time<1000>{end}, transitions);
+    cout << "fixed_time<1000>:  " << elapsed << "sec for " << transitions << " transitions" << endl;
+    return 0;
+}
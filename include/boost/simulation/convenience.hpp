@@ -28,6 +28,9 @@
 
 #ifndef BOOST_SIMULATION_CONVENIENCE_H
 #define BOOST_SIMULATION_CONVENIENCE_H
+#include <memory>
+#include <boost/simulation/pdevs/atomic.hpp>
+#include <boost/simulation/pdevs/port.hpp>
 namespace boost {
 namespace simulation {
 
@@ -39,10 +42,24 @@ namespace simulation {
  * @return a shared pointer to the atomic model constructed
  */
 
-//create a shared pointer to a pdevs::atomic model
+//create a shared pointer to a pdevs::atomic model, simulators call MODEL functions without virtual dispatch
 template<class MODEL, typename... Args>
 std::shared_ptr<pdevs::atomic<typename MODEL::time_type, typename MODEL::message_type>> make_atomic_ptr(Args... args) noexcept {
-    return std::make_shared<MODEL>(std::forward<Args>(args)...);
+    auto m = std::make_shared<MODEL>(std::forward<Args>(args)...);
+    m->template devirtualize<MODEL>();
+    return m;
+}
+
+/**
+ * @brief create the parameters of a model of kind MODEL to be shared by many instances
+ * @template MODEL model whose parameters are constructed, it defines a parameters struct and keeps them
+ *           with shared_parameters storage
+ * @param args members of the parameters struct in declaration order
+ * @return a shared pointer to the immutable parameters, to be passed to the constructor of each instance
+ */
+template<class MODEL, typename... Args>
+std::shared_ptr<const typename MODEL::parameters> make_parameters_ptr(Args... args){
+    return std::make_shared<typename MODEL::parameters>(typename MODEL::parameters{std::forward<Args>(args)...});
 }
 
 //create a shared pointer to a hardware port
@@ -0,0 +1,234 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BOOST_SIMULATION_FIXED_TIME_H
+#define BOOST_SIMULATION_FIXED_TIME_H
+#include <cstdint>
+#include <limits>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+namespace boost {
+namespace simulation {
+
+/**
+ * @brief The fixed_time class is a fixed-point representation of simulation time.
+ *
+ * Time is stored as a 64 bits count of ticks, TICKS_PER_UNIT ticks are a unit of time,
+ * e.g. fixed_time<1000> has a resolution of a millisecond when the unit is a second.
+ * Comparisons are exact integer comparisons, so imminence checks (t == next) are reliable.
+ * The largest tick count is reserved as infinity, it is returned by Inf() and absorbs additions,
+ * its opposite is reserved as the negative infinity, -Inf(), so negating a time never overflows.
+ * Arithmetic is overflow-checked: results out of range saturate to the infinity of their sign.
+ * Infinity wins when both infinities are added, as it does for the passive time advance.
+ */
+template<std::int64_t TICKS_PER_UNIT=1000>
+class fixed_time
+{
+    static_assert(TICKS_PER_UNIT > 0, "The resolution has to be a positive amount of ticks per unit");
+
+    static constexpr std::int64_t inf_ticks = std::numeric_limits<std::int64_t>::max();
+    static constexpr std::int64_t ninf_ticks = -inf_ticks;
+
+    std::int64_t _ticks;
+
+    struct from_ticks_tag{};
+    constexpr fixed_time(std::int64_t ticks, from_ticks_tag) noexcept : _ticks(ticks) {}
+
+    //helper functions, all results out of range are saturated to the infinity of their sign
+    template<class INTEGER>
+    static constexpr std::int64_t units_to_ticks(INTEGER units) noexcept {
+        return (units > static_cast<INTEGER>(0) && static_cast<std::uintmax_t>(units) >= static_cast<std::uintmax_t>(inf_ticks / TICKS_PER_UNIT))
+                ? inf_ticks
+                : ((units < static_cast<INTEGER>(0) && static_cast<std::intmax_t>(units) <= ninf_ticks / TICKS_PER_UNIT)
+                   ? ninf_ticks
+                   : static_cast<std::int64_t>(units) * TICKS_PER_UNIT);
+    }
+    //largest amount of ticks in FLOAT converting to int64, inf_ticks itself rounds up to 2^63 in FLOAT
+    template<class FLOAT>
+    static constexpr FLOAT float_ticks_limit() noexcept {
+        return static_cast<FLOAT>(inf_ticks) * (1 - std::numeric_limits<FLOAT>::epsilon() / 2);
+    }
+    template<class FLOAT>
+    static constexpr std::int64_t rounded_to_ticks(FLOAT ticks) noexcept {
+        return (ticks != ticks || ticks > float_ticks_limit<FLOAT>()) //NaN is read as infinity
+                ? inf_ticks
+                : ((ticks < -float_ticks_limit<FLOAT>())
+                   ? ninf_ticks
+                   : static_cast<std::int64_t>(ticks));
+    }
+    template<class FLOAT>
+    static constexpr std::int64_t float_to_ticks(FLOAT units) noexcept {
+        return rounded_to_ticks<FLOAT>(units * TICKS_PER_UNIT + (units < 0 ? FLOAT(-0.5) : FLOAT(0.5)));
+    }
+    static constexpr std::int64_t checked_add(std::int64_t a, std::int64_t b) noexcept {
+        return (a == inf_ticks || b == inf_ticks || (b > 0 && a >= inf_ticks - b))
+                ? inf_ticks
+                : ((a == ninf_ticks || b == ninf_ticks || (b < 0 && a <= ninf_ticks - b))
+                   ? ninf_ticks
+                   : a + b);
+    }
+
+public:
+    using rep=std::int64_t;
+    static constexpr std::int64_t ticks_per_unit = TICKS_PER_UNIT;
+
+    constexpr fixed_time() noexcept : _ticks(0) {}
+
+    /**
+     * @brief fixed_time constructs from an integer amount of units of time.
+     * The conversion is implicit, as it is for other arithmetic time representations.
+     */
+    template<class INTEGER, typename std::enable_if<std::is_integral<INTEGER>::value, int>::type=0>
+    constexpr fixed_time(INTEGER units) noexcept : _ticks(units_to_ticks(units)) {}
+
+    /**
+     * @brief fixed_time constructs from a floating point amount of units of time, rounding to the nearest tick.
+     * Amounts out of range, floating point infinities included, saturate to the infinity of their sign, NaN to Inf().
+     */
+    template<class FLOAT, typename std::enable_if<std::is_floating_point<FLOAT>::value, int>::type=0>
+    explicit fixed_time(FLOAT units) noexcept : _ticks(float_to_ticks(units)) {}
+
+    /**
+     * @brief from_ticks constructs a time from an amount of ticks, the lowest int64 is clamped to the negative infinity.
+     */
+    static constexpr fixed_time from_ticks(std::int64_t ticks) noexcept {
+        return fixed_time(ticks < ninf_ticks ? ninf_ticks : ticks, from_ticks_tag{});
+    }
+
+    /**
+     * @brief Inf returns the infinity of the time representation, used by models to passivate.
+     */
+    static constexpr fixed_time Inf() noexcept { return fixed_time(inf_ticks, from_ticks_tag{}); }
+
+    constexpr std::int64_t ticks() const noexcept { return _ticks; }
+    constexpr bool is_inf() const noexcept { return _ticks == inf_ticks; }
+
+    /**
+     * @brief to_double returns the time in units, infinities are returned as floating point infinities.
+     */
+    double to_double() const noexcept {
+        return is_inf() ? std::numeric_limits<double>::infinity()
+                        : (_ticks == ninf_ticks ? -std::numeric_limits<double>::infinity() : static_cast<double>(_ticks) / TICKS_PER_UNIT);
+    }
+
+    //arithmetic
+    friend constexpr fixed_time operator+(const fixed_time& lhs, const fixed_time& rhs) noexcept {
+        return fixed_time(checked_add(lhs._ticks, rhs._ticks), from_ticks_tag{});
+    }
+    friend constexpr fixed_time operator-(const fixed_time& lhs, const fixed_time& rhs) noexcept {
+        return fixed_time(checked_add(lhs._ticks, -rhs._ticks), from_ticks_tag{});
+    }
+    constexpr fixed_time operator-() const noexcept {
+        return fixed_time(-_ticks, from_ticks_tag{}); //the range is symmetric, the opposite of Inf() is the negative infinity
+    }
+    fixed_time& operator+=(const fixed_time& rhs) noexcept { return *this = *this + rhs; }
+    fixed_time& operator-=(const fixed_time& rhs) noexcept { return *this = *this - rhs; }
+
+    //comparisons
+    friend constexpr bool operator==(const fixed_time& lhs, const fixed_time& rhs) noexcept { return lhs._ticks == rhs._ticks; }
+    friend constexpr bool operator!=(const fixed_time& lhs, const fixed_time& rhs) noexcept { return lhs._ticks != rhs._ticks; }
+    friend constexpr bool operator<(const fixed_time& lhs, const fixed_time& rhs) noexcept { return lhs._ticks < rhs._ticks; }
+    friend constexpr bool operator>(const fixed_time& lhs, const fixed_time& rhs) noexcept { return lhs._ticks > rhs._ticks; }
+    friend constexpr bool operator<=(const fixed_time& lhs, const fixed_time& rhs) noexcept { return lhs._ticks <= rhs._ticks; }
+    friend constexpr bool operator>=(const fixed_time& lhs, const fixed_time& rhs) noexcept { return lhs._ticks >= rhs._ticks; }
+
+    /**
+     * @brief operator << writes the time in units using decimal notation, "inf" and "-inf" for the infinities.
+     */
+    friend std::ostream& operator<<(std::ostream& os, const fixed_time& t){
+        if (t.is_inf()) return os << "inf";
+        if (t._ticks == ninf_ticks) return os << "-inf";
+        std::int64_t units = t._ticks / TICKS_PER_UNIT;
+        std::int64_t rest = t._ticks % TICKS_PER_UNIT;
+        if (rest < 0) rest = -rest;
+        if (t._ticks < 0 && units == 0) os << "-";
+        os << units;
+        if (rest != 0){
+            std::string fraction;
+            for (std::int64_t scale = 1; rest != 0 && scale < TICKS_PER_UNIT; scale *= 10){
+                rest *= 10;
+                fraction.push_back(static_cast<char>('0' + rest / TICKS_PER_UNIT));
+                rest %= TICKS_PER_UNIT;
+            }
+            os << "." << fraction;
+        }
+        return os;
+    }
+    /**
+     * @brief operator >> reads a time in units using decimal notation, "inf" and "-inf" for the infinities.
+     * Digits beyond the resolution are rounded to the nearest tick, amounts out of range saturate.
+     */
+    friend std::istream& operator>>(std::istream& is, fixed_time& t){
+        std::string s;
+        if (!(is >> s)) return is;
+        std::size_t i = 0;
+        bool negative = (s[i] == '-');
+        if (s[i] == '-' || s[i] == '+') i++;
+        if (s.compare(i, std::string::npos, "inf") == 0){
+            t = negative ? -Inf() : Inf();
+            return is;
+        }
+        std::int64_t units = 0;
+        bool digits = false;
+        for (; i < s.size() && s[i] >= '0' && s[i] <= '9'; i++, digits = true){
+            units = (units > (inf_ticks - 9) / 10) ? inf_ticks : units * 10 + (s[i] - '0');
+        }
+        std::int64_t ticks = units_to_ticks(units);
+        if (i < s.size() && s[i] == '.'){
+            //accumulate the fraction in ticks, keeping one extra digit for rounding
+            std::int64_t numerator = 0, denominator = 1;
+            for (i++; i < s.size() && s[i] >= '0' && s[i] <= '9'; i++, digits = true){
+                if (denominator < std::numeric_limits<std::int64_t>::max() / (10 * TICKS_PER_UNIT)){
+                    numerator = numerator * 10 + (s[i] - '0');
+                    denominator *= 10;
+                }
+            }
+            ticks = checked_add(ticks, (numerator * TICKS_PER_UNIT * 2 + denominator) / (denominator * 2));
+        }
+        if (!digits || i != s.size()){
+            is.setstate(std::ios::failbit);
+            return is;
+        }
+        t = from_ticks(negative ? -ticks : ticks);
+        return is;
+    }
+};
+
+template<std::int64_t TICKS_PER_UNIT>
+constexpr std::int64_t fixed_time<TICKS_PER_UNIT>::inf_ticks;
+template<std::int64_t TICKS_PER_UNIT>
+constexpr std::int64_t fixed_time<TICKS_PER_UNIT>::ninf_ticks;
+template<std::int64_t TICKS_PER_UNIT>
+constexpr std::int64_t fixed_time<TICKS_PER_UNIT>::ticks_per_unit;
+
+}
+}
+
+#endif // BOOST_SIMULATION_FIXED_TIME_H
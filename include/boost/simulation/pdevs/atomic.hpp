@@ -28,12 +28,47 @@
 #ifndef BOOST_SIMULATION_PDEVS_ATOMIC_H
 #define BOOST_SIMULATION_PDEVS_ATOMIC_H
 #include <vector>
+#include <memory>
+#include <typeinfo>
+#include <type_traits>
+#include <cassert>
 #include <boost/simulation/model.hpp>
 
 namespace boost {
 namespace simulation {
 namespace pdevs {
 
+template <class TIME, class MSG>
+class atomic;
+
+/**
+ * @brief The atomic_dispatch struct is the table of functions used by simulators to run an atomic model.
+ * Each transition function is fused with the time advance function and returns its result.
+ * The clone function copies the model, it is null if the type of the model is unknown or not copyable.
+ */
+template <class TIME, class MSG>
+struct atomic_dispatch
+{
+    TIME (*internal)(atomic<TIME, MSG>&);
+    TIME (*external)(atomic<TIME, MSG>&, const std::vector<MSG>&, const TIME&);
+    TIME (*confluence)(atomic<TIME, MSG>&, const std::vector<MSG>&, const TIME&);
+    std::vector<MSG> (*out)(const atomic<TIME, MSG>&);
+    std::shared_ptr<atomic<TIME, MSG>> (*clone)(const atomic<TIME, MSG>&);
+};
+
+/**
+ * @brief The virtual_dispatch struct runs the model using the virtual functions, it is used when the type is unknown.
+ */
+template <class TIME, class MSG>
+struct virtual_dispatch;
+
+/**
+ * @brief The typed_dispatch struct runs a model of exactly type MODEL calling its functions directly.
+ * The calls are not virtual, so the compiler can inline the model functions in the dispatch functions.
+ */
+template <class MODEL>
+struct typed_dispatch;
+
 /**
  * @brief The pdevs::atomic class is the base for all PDEVS atomic models.
  *
@@ -50,9 +85,24 @@ public:
     using message_type=MSG; //Message suggested for most simulations is boost::any
     using model_type=atomic<TIME, MSG>;
 
-    atomic() noexcept : modelName("atomic") {}
+    atomic() noexcept : modelName(default_name()) {}
+
+    atomic(const std::string &name) : modelName(std::make_shared<const std::string>(name)) {}
 
-    atomic(const std::string &name) noexcept : modelName( name ) {}
+    /**
+     * @brief atomic copy constructor, the copy runs with virtual dispatch.
+     * The copy may be a model of another type derived from the same class, so the dispatch of the
+     * original is not kept, make_atomic_ptr and clone devirtualize the copies they create.
+     */
+    atomic(const atomic& other) noexcept : model<TIME>(), modelName(other.modelName) {}
+    /**
+     * @brief atomic copy assignment, the model runs with virtual dispatch afterwards, as copies do.
+     */
+    atomic& operator=(const atomic& other) noexcept {
+        modelName = other.modelName;
+        _dispatch = &virtual_dispatch<TIME, MSG>::table;
+        return *this;
+    }
     /**
      * @brief internal transition function as defined in PDEVS
      */
@@ -84,14 +134,128 @@ public:
     /**
      * @brief asString returns the name of the port
      */
-	const std::string asString() const { return modelName; }
+	const std::string asString() const { return *modelName; }
+    /**
+     * @brief print prints the state of the model, it is called by the logging_observer - To be implemented by the user, the default prints nothing
+     */
+	virtual void print() noexcept {}
     /**
-     * @brief print prints the name of the port - To be implemented by the user
+     * @brief equal_state tells if the model is in the same state as other, a model of the same type, so both
+     * behave the same from now on. It is used by the time_parallel runner to check the states guessed at the
+     * boundaries of its segments. The default answer is false, unknown, which is always safe: the segment is re-run.
      */
-	virtual void print() noexcept = 0;
+    virtual bool equal_state(const atomic<TIME, MSG>& /*other*/) const noexcept { return false; }
+    /**
+     * @brief dispatch provides the functions used by simulators to run the model.
+     */
+    const atomic_dispatch<TIME, MSG>& dispatch() const noexcept { return *_dispatch; }
+    /**
+     * @brief clone copies the model with its current state, used to instantiate prototypes.
+     * Only copyable models created by make_atomic_ptr can be cloned, for others it returns nullptr.
+     */
+    std::shared_ptr<atomic<TIME, MSG>> clone() const { return _dispatch->clone != nullptr ? _dispatch->clone(*this) : nullptr; }
+    /**
+     * @brief devirtualize tells simulators the model is exactly of type MODEL so they can avoid virtual calls.
+     * It is called by make_atomic_ptr, where the type of the model is known.
+     */
+    template <class MODEL>
+    void devirtualize() noexcept {
+        assert(typeid(*this) == typeid(MODEL) && "The model type has to match exactly the dynamic type");
+        _dispatch = &typed_dispatch<MODEL>::table;
+    }
 
 private:
-    std::string modelName;
+    /**
+     * @brief default_name is the name of the unnamed models, all of them point to the same string.
+     */
+    static const std::shared_ptr<const std::string>& default_name() noexcept {
+        static const std::shared_ptr<const std::string> name = std::make_shared<const std::string>("atomic");
+        return name;
+    }
+
+    std::shared_ptr<const std::string> modelName; //shared, copied models and unnamed models do not copy the string
+    const atomic_dispatch<TIME, MSG>* _dispatch = &virtual_dispatch<TIME, MSG>::table;
+};
+
+template <class TIME, class MSG>
+struct virtual_dispatch
+{
+    static TIME internal(atomic<TIME, MSG>& m) noexcept {
+        m.internal();
+        return m.advance();
+    }
+    static TIME external(atomic<TIME, MSG>& m, const std::vector<MSG>& mb, const TIME& t) noexcept {
+        m.external(mb, t);
+        return m.advance();
+    }
+    static TIME confluence(atomic<TIME, MSG>& m, const std::vector<MSG>& mb, const TIME& t) noexcept {
+        m.confluence(mb, t);
+        return m.advance();
+    }
+    static std::vector<MSG> out(const atomic<TIME, MSG>& m) noexcept {
+        return m.out();
+    }
+    static const atomic_dispatch<TIME, MSG> table;
+};
+
+template <class TIME, class MSG>
+const atomic_dispatch<TIME, MSG> virtual_dispatch<TIME, MSG>::table = {
+    &virtual_dispatch<TIME, MSG>::internal,
+    &virtual_dispatch<TIME, MSG>::external,
+    &virtual_dispatch<TIME, MSG>::confluence,
+    &virtual_dispatch<TIME, MSG>::out,
+    nullptr //the type is unknown, it can not be copied
+};
+
+template <class MODEL>
+struct typed_dispatch
+{
+    using TIME=typename MODEL::time_type;
+    using MSG=typename MODEL::message_type;
+
+    static TIME internal(atomic<TIME, MSG>& m) noexcept {
+        MODEL& typed = static_cast<MODEL&>(m);
+        typed.MODEL::internal();
+        return typed.MODEL::advance();
+    }
+    static TIME external(atomic<TIME, MSG>& m, const std::vector<MSG>& mb, const TIME& t) noexcept {
+        MODEL& typed = static_cast<MODEL&>(m);
+        typed.MODEL::external(mb, t);
+        return typed.MODEL::advance();
+    }
+    static TIME confluence(atomic<TIME, MSG>& m, const std::vector<MSG>& mb, const TIME& t) noexcept {
+        MODEL& typed = static_cast<MODEL&>(m);
+        typed.MODEL::confluence(mb, t);
+        return typed.MODEL::advance();
+    }
+    static std::vector<MSG> out(const atomic<TIME, MSG>& m) noexcept {
+        return static_cast<const MODEL&>(m).MODEL::out();
+    }
+    static std::shared_ptr<atomic<TIME, MSG>> clone(const atomic<TIME, MSG>& m){
+        auto c = std::make_shared<MODEL>(static_cast<const MODEL&>(m));
+        c->template devirtualize<MODEL>(); //copies start with virtual dispatch
+        return c;
+    }
+    //the clone entry of the table, null if the model is not copyable
+    using clone_type=std::shared_ptr<atomic<TIME, MSG>> (*)(const atomic<TIME, MSG>&);
+    template<class M=MODEL>
+    static constexpr clone_type clone_entry(typename std::enable_if<std::is_copy_constructible<M>::value, int>::type=0) noexcept {
+        return &typed_dispatch<M>::clone;
+    }
+    template<class M=MODEL>
+    static constexpr clone_type clone_entry(typename std::enable_if<!std::is_copy_constructible<M>::value, long>::type=0) noexcept {
+        return nullptr;
+    }
+    static const atomic_dispatch<TIME, MSG> table;
+};
+
+template <class MODEL>
+const atomic_dispatch<typename MODEL::time_type, typename MODEL::message_type> typed_dispatch<MODEL>::table = {
+    &typed_dispatch<MODEL>::internal,
+    &typed_dispatch<MODEL>::external,
+    &typed_dispatch<MODEL>::confluence,
+    &typed_dispatch<MODEL>::out,
+    typed_dispatch<MODEL>::clone_entry()
 };
 
 }
@@ -0,0 +1,420 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BOOST_SIMULATION_PDEVS_ATOMIC_ARRAY_H
+#define BOOST_SIMULATION_PDEVS_ATOMIC_ARRAY_H
+#include <vector>
+#include <queue>
+#include <utility>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <cassert>
+#include <boost/simulation/pdevs/atomic.hpp>
+#include <boost/simulation/pdevs/simd.hpp>
+
+namespace boost {
+namespace simulation {
+namespace pdevs {
+
+/**
+ * @brief The atomic_array class simulates N identical atomic models, the elements, as a single atomic model.
+ *
+ * The state of the elements is kept by the KERNEL in columns, one vector per state variable, and their
+ * next transition times are kept by the array in a contiguous vector, scanned with the kernels of simd.hpp.
+ * The internal transitions of all the imminent elements run in a single call to the KERNEL, a loop over
+ * columns the compiler can vectorize. The whole array is one model for the coordinators: one simulator,
+ * one allocation and one virtual table, no matter how many elements.
+ *
+ * The elements are coupled by index: the outputs of an element are sent to the elements coupled to it,
+ * the input of the array goes to the elements in eic and the outputs of the elements in eoc are the output
+ * of the array. The array is the closure of this coupled model of N elements, it behaves like the same
+ * atomic models coupled in a coupled model, and it is coupled to other models like any atomic model.
+ *
+ * The elements can be split in lanes, used by the ensemble: element i belongs to lane i % lanes. While few
+ * lanes have imminent elements, each lane keeps its earliest next transition in a heap of lanes, so a
+ * transition only scans the elements of the lanes due and of the lanes receiving messages. When many lanes
+ * transition together, the whole array is scanned as if there were a single lane, it is cheaper.
+ *
+ * KERNEL provides time_type, message_type and the functions, i is the index of an element:
+ * - std::size_t size() const, the number of elements.
+ * - TIME advance(std::uint32_t i) const, the time advance of the element at start.
+ * - void internal(const std::uint32_t* is, std::size_t k, TIME* ta), runs the internal transition of the
+ *   k elements in is, in increasing order, and writes the time advance of is[j] in ta[j].
+ * - TIME external(std::uint32_t i, const std::vector<MSG>& mb, const TIME& e), returns the time advance.
+ * - TIME confluence(std::uint32_t i, const std::vector<MSG>& mb), returns the time advance.
+ * - void out(std::uint32_t i, std::vector<MSG>& bag) const, appends the outputs of the element to bag.
+ */
+template<class KERNEL>
+class atomic_array : public atomic<typename KERNEL::time_type, typename KERNEL::message_type>
+{
+public:
+    using time_type=typename KERNEL::time_type;
+    using message_type=typename KERNEL::message_type;
+    using kernel_type=KERNEL;
+
+private:
+    using TIME=time_type;
+    using MSG=message_type;
+
+    KERNEL _kernel;
+    TIME _now; //time of the last transition of the array, the elements are scheduled from the start of the array
+    TIME _min; //earliest next transition of the elements
+    std::vector<TIME> _last; //last transition of each element
+    std::vector<TIME> _next; //next transition of each element
+    //the elements receiving the outputs of element i are _targets in the range [_offsets[i], _offsets[i+1])
+    std::vector<std::uint32_t> _offsets;
+    std::vector<std::uint32_t> _targets;
+    std::vector<std::uint32_t> _inputs; //elements receiving the input of the array
+    std::vector<bool> _to_out; //outputs of the element are outputs of the array
+    //lanes, element i is in lane i % _lanes, the elements of a lane are not contiguous
+    std::size_t _lanes;
+    bool _sparse = false; //lanes are scheduled by the heap, otherwise by scanning the whole array
+    std::vector<TIME> _lane_min; //earliest next transition of the elements of each lane
+    using lane_entry=std::pair<TIME, std::uint32_t>;
+    //lanes by earliest next transition, except the ones in _due, entries not matching _lane_min are stale
+    std::priority_queue<lane_entry, std::vector<lane_entry>, std::greater<lane_entry>> _lane_heap;
+    std::vector<std::uint32_t> _due; //lanes with elements scheduled at _min, in increasing order
+    std::vector<std::uint32_t> _touched; //lanes changed by the transition
+    std::vector<char> _marked; //lanes already listed, cleared after each use
+    //outputs of the imminent elements, computed once per transition by out or by the transition itself
+    //the bag of _imminents[j] is _sent in the range [_sent_offsets[j], _sent_offsets[j+1])
+    mutable std::vector<std::uint32_t> _imminents;
+    mutable std::vector<MSG> _sent;
+    mutable std::vector<std::uint32_t> _sent_offsets;
+    mutable bool _sent_ready = false;
+    mutable bool _sent_to_out = false; //the bags of the elements coupled only to the output were computed
+    //reused by every transition
+    std::vector<std::uint32_t> _internals;
+    std::vector<TIME> _ta;
+    //messages sent in the transition, listed for each receiving element in the order they were sent
+    struct letter { MSG message; std::uint32_t next; };
+    enum : std::uint32_t { none = UINT32_MAX }; //no letter
+    std::vector<letter> _mail;
+    std::vector<std::uint32_t> _first; //first letter of each element, none if it received nothing
+    std::vector<std::uint32_t> _last_letter; //last letter of each element, valid if it has a first one
+    std::vector<std::uint32_t> _receivers; //elements with letters, in the order they received the first one
+    std::vector<MSG> _bag;
+
+    void post(std::uint32_t i, const MSG& m) noexcept {
+        std::uint32_t l = static_cast<std::uint32_t>(_mail.size());
+        _mail.push_back(letter{m, none});
+        if (_first[i] == none){
+            _first[i] = l;
+            _receivers.push_back(i);
+        } else {
+            _mail[_last_letter[i]].next = l;
+        }
+        _last_letter[i] = l;
+    }
+
+    TIME schedule(const TIME& ta) const noexcept {
+        return (ta == this->infinity ? this->infinity : _now + ta);
+    }
+
+    /**
+     * @brief for_each_imminent calls f with the index of each element scheduled at _min, in increasing order.
+     * When the lanes are scheduled by the heap, only the lanes due are scanned.
+     */
+    template<class FUNC>
+    void for_each_imminent(FUNC&& f) const noexcept {
+        if (!_sparse){
+            for_each_equal(_next.data(), _next.size(), _min, f);
+        } else {
+            for (std::size_t base = 0; base < _next.size(); base += _lanes){
+                for (std::uint32_t l : _due){
+                    if (_next[base + l] == _min) f(base + l);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief schedule_lanes updates the earliest next transition of the lanes in _touched, or of all of them
+     * if all is set, and takes the lanes due next from the heap.
+     */
+    void schedule_lanes(bool all) noexcept {
+        if (all || _lane_heap.size() > 4 * _lanes){
+            //a whole pass over the array updates all the lanes and the heap is rebuilt, dropping stale entries
+            std::fill(_lane_min.begin(), _lane_min.end(), this->infinity);
+            for (std::size_t base = 0; base < _next.size(); base += _lanes){
+                for (std::size_t l = 0; l < _lanes; l++){
+                    if (_next[base + l] < _lane_min[l]) _lane_min[l] = _next[base + l];
+                }
+            }
+            std::vector<lane_entry> entries;
+            for (std::size_t l = 0; l < _lanes; l++){
+                if (_lane_min[l] != this->infinity) entries.emplace_back(_lane_min[l], static_cast<std::uint32_t>(l));
+            }
+            _lane_heap = decltype(_lane_heap)(std::greater<lane_entry>(), std::move(entries));
+        } else {
+            for (std::uint32_t l : _touched){
+                TIME m = this->infinity;
+                for (std::size_t i = l; i < _next.size(); i += _lanes){
+                    if (_next[i] < m) m = _next[i];
+                }
+                _lane_min[l] = m;
+                _marked[l] = true;
+                if (m != this->infinity) _lane_heap.emplace(m, l);
+            }
+            for (std::uint32_t l : _due){ //due lanes not changed go back to the heap
+                if (!_marked[l] && _lane_min[l] != this->infinity) _lane_heap.emplace(_lane_min[l], l);
+            }
+            for (std::uint32_t l : _touched) _marked[l] = false;
+        }
+        _due.clear();
+        _min = this->infinity;
+        while (!_lane_heap.empty()){
+            lane_entry top = _lane_heap.top();
+            if (top.first != _lane_min[top.second] || _marked[top.second]){ //stale or repeated
+                _lane_heap.pop();
+            } else if (_min == this->infinity || top.first == _min){
+                _min = top.first;
+                _marked[top.second] = true;
+                _due.push_back(top.second);
+                _lane_heap.pop();
+            } else {
+                break;
+            }
+        }
+        for (std::uint32_t l : _due) _marked[l] = false;
+        std::sort(_due.begin(), _due.end());
+    }
+
+    /**
+     * @brief imminent_outputs lists the imminent elements and computes their bags, each one only once.
+     * The elements coupled only to the output of the array are skipped when with_out is false.
+     */
+    void imminent_outputs(bool with_out) const noexcept {
+        if (_sent_ready && (_sent_to_out || !with_out)) return;
+        _imminents.clear();
+        _sent.clear();
+        _sent_offsets.clear();
+        for_each_imminent([this, with_out](std::size_t i){
+            std::uint32_t e = static_cast<std::uint32_t>(i);
+            _imminents.push_back(e);
+            _sent_offsets.push_back(static_cast<std::uint32_t>(_sent.size()));
+            if (_offsets[e] != _offsets[e + 1] || (with_out && _to_out[e])) _kernel.out(e, _sent);
+        });
+        _sent_offsets.push_back(static_cast<std::uint32_t>(_sent.size()));
+        _sent_ready = true;
+        _sent_to_out = with_out;
+    }
+
+    /**
+     * @brief transition advances the array to now, running the transitions of the imminent elements if now
+     * is the earliest next transition and the ones of the elements receiving messages.
+     */
+    void transition(const TIME& now, const std::vector<MSG>* input) noexcept {
+        _now = now;
+        _mail.clear();
+        _receivers.clear();
+        const bool imminent = (now == _min);
+        if (imminent){
+            imminent_outputs(false); //reuses the bags computed by out
+            for (std::size_t j = 0; j < _imminents.size(); j++){
+                std::uint32_t i = _imminents[j];
+                for (std::uint32_t k = _offsets[i]; k < _offsets[i + 1]; k++){
+                    for (std::uint32_t m = _sent_offsets[j]; m < _sent_offsets[j + 1]; m++) post(_targets[k], _sent[m]);
+                }
+            }
+        } else {
+            _imminents.clear();
+        }
+        _sent_ready = false;
+        if (input != nullptr){
+            for (std::uint32_t i : _inputs){
+                for (const MSG& m : *input) post(i, m);
+            }
+        }
+        //imminent elements without input run the batch internal transition
+        _internals.clear();
+        for (std::uint32_t i : _imminents){
+            if (_first[i] == none) _internals.push_back(i);
+        }
+        if (!_internals.empty()){
+            _ta.resize(_internals.size());
+            _kernel.internal(_internals.data(), _internals.size(), _ta.data());
+            for (std::size_t j = 0; j < _internals.size(); j++){
+                _last[_internals[j]] = now;
+                _next[_internals[j]] = schedule(_ta[j]);
+            }
+        }
+        //elements with input run the confluence or external transition
+        for (std::uint32_t i : _receivers){
+            _bag.clear();
+            for (std::uint32_t l = _first[i]; l != none; l = _mail[l].next) _bag.push_back(_mail[l].message);
+            _first[i] = none;
+            TIME ta = (_next[i] == now ? _kernel.confluence(i, _bag) : _kernel.external(i, _bag, now - _last[i]));
+            _last[i] = now;
+            _next[i] = schedule(ta);
+        }
+        if (!_sparse){
+            _min = min_time(_next.data(), _next.size(), this->infinity);
+            if (_lanes > 1 && imminent && 16 * _imminents.size() < _lanes){ //few lanes were due, scheduling them by the heap pays off
+                _sparse = true;
+                schedule_lanes(true);
+            }
+        } else {
+            _touched.clear();
+            if (imminent){
+                _touched = _due;
+                for (std::uint32_t l : _touched) _marked[l] = true;
+            }
+            for (std::uint32_t i : _receivers){
+                std::uint32_t l = static_cast<std::uint32_t>(i % _lanes);
+                if (!_marked[l]){
+                    _marked[l] = true;
+                    _touched.push_back(l);
+                }
+            }
+            for (std::uint32_t l : _touched) _marked[l] = false;
+            if (8 * _touched.size() > _lanes){ //many lanes changed, scanning the whole array is cheaper
+                _sparse = false;
+                _min = min_time(_next.data(), _next.size(), this->infinity);
+            } else {
+                schedule_lanes(false);
+            }
+        }
+    }
+
+protected:
+    /**
+     * @brief atomic_array constructor splitting the elements in lanes, element i is in lane i % lanes.
+     *
+     * @param kernel state and transition functions of the elements.
+     * @param lanes number of lanes, it has to divide the number of elements.
+     * @param eic elements receiving the input of the array.
+     * @param ic couplings between elements, the outputs of first are input of second.
+     * @param eoc elements whose outputs are output of the array.
+     */
+    atomic_array(KERNEL kernel, std::size_t lanes, const std::vector<std::uint32_t>& eic,
+                 const std::vector<std::pair<std::uint32_t, std::uint32_t>>& ic,
+                 const std::vector<std::uint32_t>& eoc) noexcept
+        : _kernel(std::move(kernel)), _now(0), _inputs(eic), _lanes(lanes)
+    {
+        const std::size_t n = _kernel.size();
+        assert(n <= UINT32_MAX);
+        assert(lanes > 0 && n % lanes == 0);
+        _last.assign(n, _now);
+        _first.assign(n, none);
+        _last_letter.resize(n);
+        _next.resize(n);
+        for (std::size_t i = 0; i < n; i++){
+            _next[i] = schedule(_kernel.advance(static_cast<std::uint32_t>(i)));
+        }
+        _min = min_time(_next.data(), _next.size(), this->infinity);
+        //couplings in compressed sparse rows, keeping the order of description for each source
+        _offsets.assign(n + 1, 0);
+        for (auto& c : ic){
+            assert(c.first < n && c.second < n);
+            _offsets[c.first + 1]++;
+        }
+        for (std::size_t i = 0; i < n; i++) _offsets[i + 1] += _offsets[i];
+        _targets.resize(ic.size());
+        std::vector<std::uint32_t> fill(_offsets.begin(), _offsets.end() - 1);
+        for (auto& c : ic) _targets[fill[c.first]++] = c.second;
+        _to_out.assign(n, false);
+        for (std::uint32_t i : eoc){
+            assert(i < n);
+            _to_out[i] = true;
+        }
+        _lane_min.resize(_lanes);
+        _marked.assign(_lanes, false);
+    }
+
+public:
+    /**
+     * @brief atomic_array constructor.
+     *
+     * @param kernel state and transition functions of the elements.
+     * @param eic elements receiving the input of the array.
+     * @param ic couplings between elements, the outputs of first are input of second.
+     * @param eoc elements whose outputs are output of the array.
+     */
+    atomic_array(KERNEL kernel, const std::vector<std::uint32_t>& eic,
+                 const std::vector<std::pair<std::uint32_t, std::uint32_t>>& ic,
+                 const std::vector<std::uint32_t>& eoc) noexcept
+        : atomic_array(std::move(kernel), 1, eic, ic, eoc) {}
+
+    /**
+     * @brief internal function runs the transitions of the imminent elements and routes their outputs.
+     */
+    void internal() noexcept {
+        transition(_min, nullptr);
+    }
+    /**
+     * @brief advance function.
+     * @return Time until the earliest transition of the elements.
+     */
+    TIME advance() const noexcept {
+        return (_min == this->infinity ? this->infinity : _min - _now);
+    }
+    /**
+     * @brief out function.
+     * @return outputs of the imminent elements coupled to the output of the array.
+     */
+    std::vector<MSG> out() const noexcept {
+        imminent_outputs(true);
+        std::vector<MSG> bag;
+        for (std::size_t j = 0; j < _imminents.size(); j++){
+            if (_to_out[_imminents[j]]) bag.insert(bag.end(), _sent.begin() + _sent_offsets[j], _sent.begin() + _sent_offsets[j + 1]);
+        }
+        return bag;
+    }
+    /**
+     * @brief external function delivers the input to the elements coupled to the input of the array.
+     * @param mb bag of input messages.
+     * @param t time elapsed since the last transition.
+     */
+    void external(const std::vector<MSG>& mb, const TIME& t) noexcept {
+        transition(_now + t, &mb);
+    }
+    /**
+     * @brief confluence function runs the imminent elements and delivers the input in the same transition.
+     * The time elapsed since the last transition is the time advance, so it is not needed.
+     * @param mb bag of input messages.
+     */
+    void confluence(const std::vector<MSG>& mb, const TIME& /*t*/) noexcept {
+        transition(_min, &mb);
+    }
+
+    /**
+     * @brief size returns the number of elements.
+     */
+    std::size_t size() const noexcept { return _next.size(); }
+    /**
+     * @brief kernel gives access to the columns of state of the elements.
+     */
+    const KERNEL& kernel() const noexcept { return _kernel; }
+};
+
+}
+}
+}
+
+#endif // BOOST_SIMULATION_PDEVS_ATOMIC_ARRAY_H
@@ -53,7 +53,6 @@ class event_stream : public atomic<TIME, MSG>
     TIME _prefetched_time;
     MSG _prefetched_message;
     void (*_process)(const std::string&, TIME&, MSG&); //Parser process reads the string and sets the time,msg
-    const TIME infinity=1000; // Defining local infinity for testing purposes
 
 
     //helper function
@@ -68,7 +67,7 @@ class event_stream : public atomic<TIME, MSG>
         while(!_ps->eof() && line.empty());
         if (_ps->eof() && line.empty()){
             //if there is no more messages, set infinity as next event time
-            _prefetched_time = infinity;//atomic<TIME, MSG>::infinity;
+            _prefetched_time = atomic<TIME, MSG>::infinity;
         } else { //else cache the las message fetched
             //intermediary vars for casting
             TIME t_next;
@@ -80,7 +79,7 @@ class event_stream : public atomic<TIME, MSG>
                 line.clear();
                 std::getline(*_ps, line);
                 if (_ps->eof() && line.empty()){
-                    _prefetched_time = infinity;//atomic<TIME, MSG>::infinity;
+                    _prefetched_time = atomic<TIME, MSG>::infinity;
                     return;
                 } else {
                     _process(line, t_next, m_next);
@@ -126,7 +125,7 @@ public:
         std::string line;
         std::getline(*_ps, line); //needs at least one call to detect eof
         if (_ps->eof() && line.empty()){
-            _next = infinity;//atomic<TIME, MSG>::infinity;
+            _next = atomic<TIME, MSG>::infinity;
         } else {
             //intermediary vars for casting
             TIME t_next;
@@ -151,7 +150,7 @@ public:
      * @return TIME until next internal event.
      */
     TIME advance() const noexcept {
-        return (_next==infinity?_next:_next-_last);//return (_next==atomic<TIME, MSG>::infinity?_next:_next-_last);
+        return (_next==atomic<TIME, MSG>::infinity?_next:_next-_last);
 
     }
     /**
@@ -167,6 +166,15 @@ public:
      * @brief invalid confluence function.
      */
     void confluence(const std::vector<MSG>& mb, const TIME& t)  noexcept { assert(false && "Non external input is expected in this model"); }
+    /**
+     * @brief equal_state compares streams reading the same trace, they are in the same state when they wait
+     * for the same events. The times are absolute, so the time of the last event read does not matter.
+     */
+    bool equal_state(const atomic<TIME, MSG>& other) const noexcept {
+        const event_stream* o = dynamic_cast<const event_stream*>(&other);
+        return o != nullptr && _next == o->_next && _output.size() == o->_output.size()
+            && (_next == atomic<TIME, MSG>::infinity || _prefetched_time == o->_prefetched_time);
+    }
 
 };
 
@@ -27,7 +27,10 @@
 
 #ifndef BOOST_SIMULATION_PDEVS_BM_GENERATOR_H
 #define BOOST_SIMULATION_PDEVS_BM_GENERATOR_H
+#include <vector>
+#include <memory>
 #include <boost/simulation/pdevs/atomic.hpp>
+#include <boost/simulation/pdevs/basic_models/parameters.hpp>
 
 namespace boost {
 namespace simulation {
@@ -44,12 +47,23 @@ namespace basic_models {
  * - external = {}
  * - out ("active", t) = outvalue
  * - advance(phase, t) = period - t
+ *
+ * The parameters are kept in each generator, shared_parameters as STORAGE shares them among generators.
 */
-template<class TIME, class MSG>
+template<class TIME, class MSG, class STORAGE=own_parameters>
 class generator : public atomic<TIME, MSG>
 {
-    TIME _period;
-    std::vector<MSG> _outvalue;
+public:
+    /**
+     * @brief The parameters of a generator never change, generators with the same parameters can share them.
+     */
+    struct parameters
+    {
+        TIME period; //amount of time between ticks
+        std::vector<MSG> outvalue; //bag returned by out function
+    };
+private:
+    typename STORAGE::template holder<parameters> _parameters;
 public:
     /**
      * @brief Generator constructor.
@@ -57,7 +71,14 @@ public:
      * @param period Amount of time between ticks.
      * @param outvalue Value to be returned by out function.
      */
-    explicit generator(TIME period, MSG outvalue=1) noexcept : _period(period), _outvalue(std::vector<MSG>{outvalue}) {}
+    explicit generator(TIME period, MSG outvalue=1)
+        : _parameters(parameters{period, std::vector<MSG>{outvalue}}) {}
+    /**
+     * @brief Generator constructor sharing the parameters with other generators, only for shared_parameters STORAGE.
+     *
+     * @param p parameters of the generator, see make_parameters_ptr.
+     */
+    explicit generator(std::shared_ptr<const parameters> p) noexcept : _parameters(std::move(p)) {}
     /**
      * @brief internal function.
      */
@@ -66,12 +87,12 @@ public:
      * @brief advance function.
      * @return Time until next internal event.
      */
-    TIME advance() const noexcept { return _period; }
+    TIME advance() const noexcept { return _parameters.get().period; }
     /**
      * @brief out function.
      * @return MSG defined in contruction.
      */
-    std::vector<MSG> out() const noexcept { return _outvalue; }
+    std::vector<MSG> out() const noexcept { return _parameters.get().outvalue; }
     /**
      * @brief external function domain is empty, so it throws.
      * @param msg external input message.
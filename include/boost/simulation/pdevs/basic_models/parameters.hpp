@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BOOST_SIMULATION_PDEVS_BM_PARAMETERS_H
+#define BOOST_SIMULATION_PDEVS_BM_PARAMETERS_H
+#include <memory>
+#include <utility>
+#include <cassert>
+
+namespace boost {
+namespace simulation {
+namespace pdevs {
+namespace basic_models {
+
+/**
+ * @brief own_parameters tells a basic model to keep its parameters in the model itself, it is the default.
+ * Nothing is allocated for them and reading them takes no indirection.
+ */
+struct own_parameters
+{
+    template<class PARAMETERS>
+    class holder
+    {
+        PARAMETERS _value;
+    public:
+        explicit holder(PARAMETERS p) : _value(std::move(p)) {}
+        const PARAMETERS& get() const noexcept { return _value; }
+    };
+};
+
+/**
+ * @brief shared_parameters tells a basic model to keep its parameters behind a shared pointer, so a population
+ * of models with the same parameters keeps a single copy of them, see make_parameters_ptr.
+ */
+struct shared_parameters
+{
+    template<class PARAMETERS>
+    class holder
+    {
+        std::shared_ptr<const PARAMETERS> _value;
+    public:
+        explicit holder(PARAMETERS p) : _value(std::make_shared<const PARAMETERS>(std::move(p))) {}
+        explicit holder(std::shared_ptr<const PARAMETERS> p) noexcept : _value(std::move(p)) {
+            assert(_value && "The parameters are required");
+        }
+        const PARAMETERS& get() const noexcept { return *_value; }
+    };
+};
+
+}
+}
+}
+}
+#endif // BOOST_SIMULATION_PDEVS_BM_PARAMETERS_H
@@ -28,7 +28,9 @@
 #ifndef BOOST_SIMULATION_PDEVS_PROCESSOR_H
 #define BOOST_SIMULATION_PDEVS_PROCESSOR_H
 #include <queue>
+#include <memory>
 #include <boost/simulation/pdevs/atomic.hpp>
+#include <boost/simulation/pdevs/basic_models/parameters.hpp>
 
 namespace boost {
 namespace simulation {
@@ -48,18 +50,37 @@ namespace basic_models {
  * - confluence -> internal; external
  * - out (active, t, job) = job
  * - advance(phase, t, job) = t
+ *
+ * The parameters are kept in each processor, shared_parameters as STORAGE shares them among processors.
 */
-template<class TIME, class MSG>
+template<class TIME, class MSG, class STORAGE=own_parameters>
 class processor : public atomic<TIME, MSG>
 {
+public:
+    /**
+     * @brief The parameters of a processor never change, processors with the same parameters can share them.
+     */
+    struct parameters
+    {
+        TIME processing; //time to process each job
+    };
+private:
+    typename STORAGE::template holder<parameters> _parameters;
     TIME _next;
     std::queue<MSG> _jobs;
-    TIME _processing;
 public:
     /**
      * @brief Processor constructor.
      */
-    explicit processor(TIME processing) noexcept : _next(atomic<TIME, MSG>::infinity), _processing(processing){}
+    explicit processor(TIME processing)
+        : _parameters(parameters{processing}), _next(atomic<TIME, MSG>::infinity) {}
+    /**
+     * @brief Processor constructor sharing the parameters with other processors, only for shared_parameters STORAGE.
+     *
+     * @param p parameters of the processor, see make_parameters_ptr.
+     */
+    explicit processor(std::shared_ptr<const parameters> p) noexcept
+        : _parameters(std::move(p)), _next(atomic<TIME, MSG>::infinity) {}
     /**
      * @brief internal function.
      *
@@ -67,7 +88,7 @@ public:
      */
     void internal() noexcept {
         _jobs.pop();
-        _next = (0 == _jobs.size()?atomic<TIME, MSG>::infinity:_processing);
+        _next = (0 == _jobs.size()?atomic<TIME, MSG>::infinity:_parameters.get().processing);
     }
     /**
      * @brief advance function.
@@ -88,7 +109,7 @@ public:
      * @param t time the external input is received (relative to last advace).
      */
      void external(const std::vector<MSG>& mb, const TIME& t) noexcept {
-        _next = (0 == _jobs.size()?_processing: (_next-t));
+        _next = (0 == _jobs.size()?_parameters.get().processing: (_next-t));
         for (auto& m :mb){
             _jobs.push(m);
         }
@@ -103,6 +124,14 @@ public:
         internal();
         external(mb, TIME(0));
     }
+    /**
+     * @brief equal_state is true for idle processors with the same processing time.
+     * Busy processors are never reported equal, jobs may not be comparable and their time left is relative.
+     */
+    bool equal_state(const atomic<TIME, MSG>& other) const noexcept {
+        const processor* o = dynamic_cast<const processor*>(&other);
+        return o != nullptr && _jobs.empty() && o->_jobs.empty() && _parameters.get().processing == o->_parameters.get().processing;
+    }
 
 };
 
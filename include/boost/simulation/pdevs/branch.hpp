@@ -0,0 +1,170 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BOOST_SIMULATION_PDEVS_BRANCH_H
+#define BOOST_SIMULATION_PDEVS_BRANCH_H
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdio>
+#include <cerrno>
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <boost/simulation/pdevs/runner.hpp>
+
+namespace boost {
+namespace simulation {
+namespace pdevs {
+
+/**
+ * @brief branch runs what-if branches from the state of a simulation at t, each one in a process forked from this one.
+ *
+ * The runner is run until t, then n children are forked. Child i calls f(i, r) on its copy of the runner, where f
+ * applies the intervention of the branch, like injecting events or changing parameters of the models, simulates
+ * it to completion and returns the results as a string. The memory of the warm simulation is shared copy-on-write
+ * with the children, only the pages a branch changes are copied. The results go back through pipes, the parent
+ * is not changed by the branches and can go on simulating or branch again later.
+ *
+ * It is only available in POSIX systems. Fork copies only the calling thread, so no other thread should be
+ * changing the simulation. The standard streams are flushed before forking, so buffered output is not repeated.
+ *
+ * @param r is the runner of the simulation, left at t.
+ * @param t is the time the branches start from, events scheduled at t are run by the branches.
+ * @param n is the number of branches.
+ * @param f runs branch i from the runner, std::string f(std::size_t i, RUNNER& r).
+ * @param processes is the maximum number of children running at the same time, 0 for all the branches.
+ * @return the results of the branches in order.
+ * @throw std::system_error if a pipe or a child can not be created.
+ * @throw std::runtime_error if a branch does not finish normally.
+ */
+template<class RUNNER, class TIME, class FUNC>
+std::vector<std::string> branch(RUNNER& r, const TIME& t, std::size_t n, FUNC&& f, std::size_t processes=0)
+{
+    struct child{
+        pid_t pid;
+        int fd; //read end of the pipe of the results
+        std::size_t index; //branch run by the child
+    };
+    r.runUntil(t);
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+    if (processes == 0) processes = n;
+    std::vector<std::string> results(n);
+    std::vector<child> running;
+    std::vector<pollfd> fds;
+    std::size_t started = 0;
+    std::size_t failed = n; //first branch failing, n if none
+
+    auto spawn = [&](std::size_t i){
+        int ends[2];
+        if (pipe(ends) != 0) throw std::system_error(errno, std::generic_category(), "branch: pipe");
+        pid_t pid = fork();
+        if (pid < 0){
+            int e = errno;
+            close(ends[0]);
+            close(ends[1]);
+            throw std::system_error(e, std::generic_category(), "branch: fork");
+        }
+        if (pid == 0){ //child: run the branch, send its results and leave without running the destructors of the parent
+            close(ends[0]);
+            int status = 0;
+            try {
+                std::string out = f(i, r);
+                for (std::size_t sent = 0; sent < out.size(); ){
+                    ssize_t w = write(ends[1], out.data() + sent, out.size() - sent);
+                    if (w < 0 && errno == EINTR) continue;
+                    if (w <= 0){
+                        status = 1;
+                        break;
+                    }
+                    sent += static_cast<std::size_t>(w);
+                }
+            } catch (...) {
+                status = 1;
+            }
+            std::cout.flush();
+            std::cerr.flush();
+            _exit(status);
+        }
+        close(ends[1]);
+        running.push_back(child{pid, ends[0], i});
+    };
+
+    auto reap = [&](const child& c){
+        close(c.fd);
+        int status = 0;
+        pid_t waited;
+        while ((waited = waitpid(c.pid, &status, 0)) < 0 && errno == EINTR);
+        //a child that can not be waited for is not known to have finished normally
+        if (waited < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) failed = std::min(failed, c.index);
+    };
+
+    try {
+        while (started < n || !running.empty()){
+            while (started < n && running.size() < processes) spawn(started++);
+            fds.clear();
+            for (auto& c : running) fds.push_back(pollfd{c.fd, POLLIN, 0});
+            if (poll(fds.data(), fds.size(), -1) < 0){
+                if (errno == EINTR) continue;
+                throw std::system_error(errno, std::generic_category(), "branch: poll");
+            }
+            //read the children ready, the ones finished leave the running list
+            std::size_t kept = 0;
+            for (std::size_t k = 0; k < running.size(); k++){
+                bool done = false;
+                if (fds[k].revents != 0){
+                    char buffer[4096];
+                    ssize_t got = read(running[k].fd, buffer, sizeof(buffer));
+                    if (got > 0){
+                        results[running[k].index].append(buffer, static_cast<std::size_t>(got));
+                    } else if (got == 0 || errno != EINTR){
+                        reap(running[k]);
+                        done = true;
+                    }
+                }
+                if (!done) running[kept++] = running[k];
+            }
+            running.resize(kept);
+        }
+    } catch (...) {
+        for (auto& c : running) reap(c); //no child is left behind
+        throw;
+    }
+    if (failed != n) throw std::runtime_error("branch: branch " + std::to_string(failed) + " did not finish normally");
+    return results;
+}
+
+}
+}
+}
+
+#endif // BOOST_SIMULATION_PDEVS_BRANCH_H
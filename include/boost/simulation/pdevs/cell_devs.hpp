@@ -0,0 +1,419 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BOOST_SIMULATION_PDEVS_CELL_DEVS_H
+#define BOOST_SIMULATION_PDEVS_CELL_DEVS_H
+#include <vector>
+#include <queue>
+#include <utility>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <boost/simulation/pdevs/atomic.hpp>
+
+namespace boost {
+namespace simulation {
+namespace pdevs {
+
+/**
+ * @brief A stencil lists the neighbors of a cell by their coordinates relative to it, one vector per neighbor.
+ */
+using stencil=std::vector<std::vector<int>>;
+
+/**
+ * @brief moore returns the cells at distance radius or less in every dimension, the cell itself first.
+ */
+inline stencil moore(std::size_t dims, int radius=1){
+    stencil s{std::vector<int>(dims, 0)};
+    std::vector<int> c(dims, -radius);
+    for (bool done = (dims == 0); !done; ){
+        bool origin = true;
+        for (int x : c) origin = origin && (x == 0);
+        if (!origin) s.push_back(c);
+        done = true;
+        for (std::size_t d = dims; d-- > 0; ){ //next coordinates, the last dimension is the fastest
+            if (c[d] < radius){
+                c[d]++;
+                done = false;
+                break;
+            }
+            c[d] = -radius;
+        }
+    }
+    return s;
+}
+
+/**
+ * @brief von_neumann returns the cells at Manhattan distance radius or less, the cell itself first.
+ */
+inline stencil von_neumann(std::size_t dims, int radius=1){
+    stencil s;
+    for (auto& c : moore(dims, radius)){
+        int distance = 0;
+        for (int x : c) distance += (x < 0 ? -x : x);
+        if (distance <= radius) s.push_back(c);
+    }
+    return s;
+}
+
+/**
+ * @brief The neighborhood class gives the local computing function the states of the neighbors of a cell,
+ * in the order of the stencil.
+ */
+template<class STATE>
+class neighborhood
+{
+    const STATE* _states;
+    std::size_t _size;
+public:
+    neighborhood(const STATE* states, std::size_t size) noexcept : _states(states), _size(size) {}
+    const STATE& operator[](std::size_t k) const noexcept { return _states[k]; }
+    std::size_t size() const noexcept { return _size; }
+    const STATE* begin() const noexcept { return _states; }
+    const STATE* end() const noexcept { return _states + _size; }
+};
+
+/**
+ * @brief The cell_space class is a Cell-DEVS model: a grid of cells of any number of dimensions, all of them
+ * running the same local computing function over the states of the cells in their neighborhood.
+ *
+ * The cells are not models, their states are kept in contiguous vectors and the neighbors are found by
+ * the stencil, so there are no couplings and no messages between cells. When a cell changes its state
+ * the cells having it as neighbor compute their next state, only those, and the ones whose next state
+ * differs from the current one change after the delay. The delay is inertial: a change scheduled is
+ * replaced if the cell computes a different state before it happens, and cancelled if it computes its
+ * current state. The grid is a torus unless a border state is given for the cells out of it.
+ *
+ * The whole grid is a single atomic model for coordinators. The changes of the cells in eoc are its output,
+ * its input sets the state of cells. RULE provides time_type, message_type, state_type and the functions:
+ * - state_type local(std::uint32_t cell, const neighborhood<state_type>& n), the local computing function.
+ * - std::pair<std::uint32_t, state_type> in(const message_type& m) const, the cell and state set by an input.
+ * - message_type out(std::uint32_t cell, const state_type& s) const, the output when the cell changes to s.
+ */
+template<class RULE>
+class cell_space : public atomic<typename RULE::time_type, typename RULE::message_type>
+{
+public:
+    using time_type=typename RULE::time_type;
+    using message_type=typename RULE::message_type;
+    using state_type=typename RULE::state_type;
+    using rule_type=RULE;
+
+private:
+    using TIME=time_type;
+    using MSG=message_type;
+    using STATE=state_type;
+
+    RULE _rule;
+    std::vector<std::size_t> _shape;
+    std::vector<std::size_t> _strides; //of each dimension in the linear index, row major
+    stencil _stencil;
+    std::vector<std::ptrdiff_t> _offsets; //linear offset of each neighbor, for cells far from the edges
+    std::vector<std::size_t> _reach; //largest offset of the stencil in each dimension
+    bool _wrap;
+    STATE _border; //state of the cells out of the grid if it does not wrap
+    TIME _delay;
+    TIME _now; //time of the last transition, the cells are scheduled from the start of the space
+    TIME _min; //earliest change scheduled
+    std::vector<STATE> _state; //current state of each cell
+    std::vector<STATE> _pending; //state each cell changes to at _next
+    std::vector<TIME> _next; //time of the change of each cell, infinity if none
+    std::vector<bool> _to_out; //changes of the cell are outputs of the space
+    //changes scheduled, replaced ones are skipped when they reach the top
+    using event=std::pair<TIME, std::uint32_t>;
+    std::priority_queue<event, std::vector<event>, std::greater<event>> _fel;
+    //reused by every transition
+    std::vector<std::uint32_t> _imminents; //cells changing at _min
+    std::vector<std::uint32_t> _changed;
+    std::vector<std::uint32_t> _influenced;
+    std::vector<char> _marked; //cell already in _influenced or _imminents
+    std::vector<STATE> _view;
+    std::vector<std::size_t> _coords;
+
+    //coordinates of cell i in _coords, tells if all its neighbors are in the grid without wrapping
+    bool inner(std::uint32_t i) noexcept {
+        bool in = true;
+        std::size_t rest = i;
+        for (std::size_t d = 0; d < _shape.size(); d++){
+            _coords[d] = rest / _strides[d];
+            rest %= _strides[d];
+            in = in && _coords[d] >= _reach[d] && _coords[d] + _reach[d] < _shape[d];
+        }
+        return in;
+    }
+
+    //cell at sign times the neighbor k of the cell in _coords, false if it is out of the grid
+    bool relative(std::size_t k, int sign, std::uint32_t& j) const noexcept {
+        std::size_t index = 0;
+        for (std::size_t d = 0; d < _shape.size(); d++){
+            long long size = static_cast<long long>(_shape[d]);
+            long long x = static_cast<long long>(_coords[d]) + sign * _stencil[k][d];
+            if (x < 0 || x >= size){
+                if (!_wrap) return false;
+                x = ((x % size) + size) % size;
+            }
+            index += static_cast<std::size_t>(x) * _strides[d];
+        }
+        j = static_cast<std::uint32_t>(index);
+        return true;
+    }
+
+    TIME schedule(const TIME& ta) const noexcept {
+        return (ta == this->infinity ? this->infinity : _now + ta);
+    }
+
+    /**
+     * @brief evaluate runs the local computing function of cell i and schedules, replaces or cancels its change.
+     */
+    void evaluate(std::uint32_t i) noexcept {
+        _view.clear();
+        if (inner(i)){
+            for (std::ptrdiff_t o : _offsets) _view.push_back(_state[i + o]);
+        } else {
+            for (std::size_t k = 0; k < _stencil.size(); k++){
+                std::uint32_t j;
+                _view.push_back(relative(k, 1, j) ? _state[j] : _border);
+            }
+        }
+        STATE s = _rule.local(i, neighborhood<STATE>(_view.data(), _view.size()));
+        if (s == _state[i]){
+            _next[i] = this->infinity;
+        } else if (_next[i] == this->infinity || !(s == _pending[i])){
+            _pending[i] = s;
+            _next[i] = schedule(_delay);
+            _fel.emplace(_next[i], i);
+        }
+    }
+
+    /**
+     * @brief influence collects the cells having i as neighbor, each one once.
+     */
+    void influence(std::uint32_t i) noexcept {
+        auto add = [this](std::uint32_t j){
+            if (_marked[j]) return;
+            _marked[j] = true;
+            _influenced.push_back(j);
+        };
+        if (inner(i)){
+            for (std::ptrdiff_t o : _offsets) add(static_cast<std::uint32_t>(i - o));
+        } else {
+            for (std::size_t k = 0; k < _stencil.size(); k++){
+                std::uint32_t j;
+                if (relative(k, -1, j)) add(j);
+            }
+        }
+    }
+
+    /**
+     * @brief imminents finds the earliest change scheduled and the cells changing then.
+     */
+    void imminents() noexcept {
+        _imminents.clear();
+        _min = this->infinity;
+        while (!_fel.empty()){
+            event e = _fel.top();
+            if (_next[e.second] != e.first){ //replaced or cancelled
+                _fel.pop();
+                continue;
+            }
+            if (_min == this->infinity) _min = e.first;
+            if (e.first != _min) break;
+            if (!_marked[e.second]){ //a cell cancelled and scheduled again at the same time is twice in the queue
+                _marked[e.second] = true;
+                _imminents.push_back(e.second);
+            }
+            _fel.pop();
+        }
+        for (std::uint32_t i : _imminents) _marked[i] = false;
+    }
+
+    /**
+     * @brief transition advances the space to now, the imminent cells change if now is the earliest change
+     * and the input sets the state of cells, then the cells having a changed neighbor are evaluated.
+     */
+    void transition(const TIME& now, const std::vector<MSG>* input) noexcept {
+        _now = now;
+        _changed.clear();
+        for (std::uint32_t i : _imminents){
+            if (_next[i] != now){ //not its time yet, it waits in the queue again
+                if (_next[i] != this->infinity) _fel.emplace(_next[i], i);
+                continue;
+            }
+            _state[i] = _pending[i];
+            _next[i] = this->infinity;
+            _changed.push_back(i);
+        }
+        if (input != nullptr){
+            for (const MSG& m : *input){
+                std::pair<std::uint32_t, STATE> set = _rule.in(m);
+                assert(set.first < _state.size());
+                _state[set.first] = set.second;
+                _next[set.first] = this->infinity;
+                _changed.push_back(set.first);
+            }
+        }
+        _influenced.clear();
+        for (std::uint32_t i : _changed) influence(i);
+        for (std::uint32_t i : _influenced){
+            _marked[i] = false;
+            evaluate(i);
+        }
+        imminents();
+    }
+
+    void setup(std::vector<std::size_t> shape, const stencil& neighbors, std::vector<STATE> initial,
+               const std::vector<std::uint32_t>& eoc) noexcept {
+        _shape = std::move(shape);
+        _strides.assign(_shape.size(), 1);
+        for (std::size_t d = _shape.size(); d-- > 1; ) _strides[d - 1] = _strides[d] * _shape[d];
+        std::size_t n = (_shape.empty() ? 0 : _strides[0] * _shape[0]);
+        assert(n <= UINT32_MAX);
+        assert(initial.size() == n);
+        _stencil = neighbors;
+        _reach.assign(_shape.size(), 0);
+        for (auto& c : _stencil){
+            assert(c.size() == _shape.size());
+            std::ptrdiff_t o = 0;
+            for (std::size_t d = 0; d < _shape.size(); d++){
+                o += c[d] * static_cast<std::ptrdiff_t>(_strides[d]);
+                std::size_t r = static_cast<std::size_t>(c[d] < 0 ? -c[d] : c[d]);
+                if (r > _reach[d]) _reach[d] = r;
+            }
+            _offsets.push_back(o);
+        }
+        _coords.resize(_shape.size());
+        _state = std::move(initial);
+        _pending = _state;
+        _next.assign(n, this->infinity);
+        _marked.assign(n, false);
+        _to_out.assign(n, false);
+        for (std::uint32_t i : eoc){
+            assert(i < n);
+            _to_out[i] = true;
+        }
+        //every cell computes its state once at start, later only the ones with a changed neighbor do
+        for (std::size_t i = 0; i < n; i++) evaluate(static_cast<std::uint32_t>(i));
+        imminents();
+    }
+
+public:
+    /**
+     * @brief cell_space constructor for a grid wrapped in every dimension, a torus.
+     *
+     * @param rule local computing function and conversion of the cell states from input and to output.
+     * @param shape number of cells in each dimension.
+     * @param neighbors stencil of the neighborhood, see moore and von_neumann.
+     * @param initial state of the cells, by linear index, the last dimension is the fastest.
+     * @param delay time from the computation of a new state to the change of the cell.
+     * @param eoc cells whose changes are output of the space.
+     */
+    cell_space(RULE rule, std::vector<std::size_t> shape, const stencil& neighbors, std::vector<STATE> initial,
+               TIME delay, const std::vector<std::uint32_t>& eoc) noexcept
+        : _rule(std::move(rule)), _wrap(true), _border(), _delay(delay), _now(0), _min(this->infinity)
+    {
+        setup(std::move(shape), neighbors, std::move(initial), eoc);
+    }
+    /**
+     * @brief cell_space constructor for a bounded grid, the neighbors out of it have the border state.
+     */
+    cell_space(RULE rule, std::vector<std::size_t> shape, const stencil& neighbors, std::vector<STATE> initial,
+               TIME delay, const std::vector<std::uint32_t>& eoc, STATE border) noexcept
+        : _rule(std::move(rule)), _wrap(false), _border(border), _delay(delay), _now(0), _min(this->infinity)
+    {
+        setup(std::move(shape), neighbors, std::move(initial), eoc);
+    }
+
+    /**
+     * @brief internal function changes the imminent cells.
+     */
+    void internal() noexcept {
+        transition(_min, nullptr);
+    }
+    /**
+     * @brief advance function.
+     * @return Time until the earliest change of a cell.
+     */
+    TIME advance() const noexcept {
+        return (_min == this->infinity ? this->infinity : _min - _now);
+    }
+    /**
+     * @brief out function.
+     * @return the changes of the imminent cells in eoc.
+     */
+    std::vector<MSG> out() const noexcept {
+        std::vector<MSG> bag;
+        for (std::uint32_t i : _imminents){
+            if (_to_out[i]) bag.push_back(_rule.out(i, _pending[i]));
+        }
+        return bag;
+    }
+    /**
+     * @brief external function sets the state of the cells in the input.
+     * @param mb bag of input messages.
+     * @param t time elapsed since the last transition.
+     */
+    void external(const std::vector<MSG>& mb, const TIME& t) noexcept {
+        transition(_now + t, &mb);
+    }
+    /**
+     * @brief confluence function changes the imminent cells and then sets the ones in the input.
+     * The time elapsed since the last transition is the time advance, so it is not needed.
+     * @param mb bag of input messages.
+     */
+    void confluence(const std::vector<MSG>& mb, const TIME& /*t*/) noexcept {
+        transition(_min, &mb);
+    }
+
+    /**
+     * @brief size returns the number of cells.
+     */
+    std::size_t size() const noexcept { return _state.size(); }
+    /**
+     * @brief index returns the linear index of the cell with the given coordinates.
+     */
+    std::uint32_t index(const std::vector<std::size_t>& coords) const noexcept {
+        assert(coords.size() == _shape.size());
+        std::size_t i = 0;
+        for (std::size_t d = 0; d < _shape.size(); d++) i += coords[d] * _strides[d];
+        return static_cast<std::uint32_t>(i);
+    }
+    /**
+     * @brief state returns the current state of cell i.
+     */
+    const STATE& state(std::uint32_t i) const noexcept { return _state[i]; }
+    /**
+     * @brief rule gives access to the local computing function.
+     */
+    const RULE& rule() const noexcept { return _rule; }
+};
+
+}
+}
+}
+
+#endif // BOOST_SIMULATION_PDEVS_CELL_DEVS_H
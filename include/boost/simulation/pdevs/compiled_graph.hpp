@@ -0,0 +1,255 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BOOST_SIMULATION_PDEVS_COMPILED_GRAPH_H
+#define BOOST_SIMULATION_PDEVS_COMPILED_GRAPH_H
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <memory>
+#include <boost/simulation/pdevs/coupled.hpp>
+
+namespace boost {
+namespace simulation {
+namespace pdevs {
+
+/**
+ * @brief The compiled_graph class loads a flattened topology saved in a binary file.
+ * Models with a stable topology can resolve their couplings once, save the flat_description of
+ * the flattened_coupled with save, and on later runs bind the loaded graph to new model instances.
+ * Binding skips reading coupled descriptions and resolving couplings, the indexes are taken as they are.
+ * The file keeps only indexes and a tag per model, the models are created by a factory receiving both.
+ * The relays and the couplings are saved already resolved, as indexes. The simulators, relays and routes
+ * between them are process memory and are not saved, the coordinator of a bound model creates them again
+ * from the indexes in a single pass over the models and couplings.
+ *
+ * The layout is a header of 64 bits words (magic, byte order mark, bytes per word, models, relays, external inputs,
+ * couplings, external outputs) followed by the arrays of 64 bits words: tags, external input indexes,
+ * coupling offsets (one more than models and relays), coupling targets and external output indexes. Words are written
+ * in the byte order of the machine saving the file, files written with another byte order are rejected.
+ */
+class compiled_graph
+{
+    struct header{
+        std::uint64_t magic;
+        std::uint64_t byte_order;
+        std::uint64_t word_size;
+        std::uint64_t models;
+        std::uint64_t relays;
+        std::uint64_t external_inputs;
+        std::uint64_t couplings;
+        std::uint64_t external_outputs;
+    };
+    static constexpr std::uint64_t file_magic = 0x3148504152474350ull; //PCGRAPH1 in little endian
+    static constexpr std::uint64_t byte_order_mark = 0x0102030405060708ull;
+    static constexpr std::uint64_t swapped_byte_order_mark = 0x0807060504030201ull; //the mark read in the other byte order
+
+    header _header;
+    std::vector<std::uint64_t> _tags;
+    //indexes are kept as the flat_description keeps them, so binding copies or moves them as they are
+    std::vector<std::size_t> _external_inputs;
+    std::vector<std::size_t> _offsets;
+    std::vector<std::size_t> _targets;
+    std::vector<std::size_t> _external_outputs;
+
+    template<class T>
+    static void write_words(std::ofstream& out, const std::vector<T>& v){
+        std::vector<std::uint64_t> words(v.begin(), v.end());
+        out.write(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(std::uint64_t));
+    }
+
+    template<class WORD>
+    static void read_words(std::ifstream& in, std::uint64_t n, std::vector<WORD>& to){
+        if (sizeof(WORD) == sizeof(std::uint64_t)){ //read in place
+            to.resize(n);
+            in.read(reinterpret_cast<char*>(to.data()), n * sizeof(std::uint64_t));
+        } else {
+            std::vector<std::uint64_t> words(n);
+            in.read(reinterpret_cast<char*>(words.data()), n * sizeof(std::uint64_t));
+            to.assign(words.begin(), words.end());
+        }
+    }
+
+    template<class TIME, class MSG, class FACTORY>
+    typename flattened_coupled<TIME, MSG>::flat_description create_models(FACTORY& factory) const {
+        typename flattened_coupled<TIME, MSG>::flat_description flat;
+        flat.models.reserve(_header.models);
+        for (std::size_t i = 0; i < _header.models; i++){
+            std::shared_ptr<atomic<TIME, MSG>> m = factory(i, _tags[i]);
+            if (m == nullptr) throw std::invalid_argument("compiled_graph: the factory returned no model for index " + std::to_string(i));
+            flat.models.push_back(std::move(m));
+        }
+        return flat;
+    }
+
+public:
+    /**
+     * @brief compiled_graph reads the file and checks its header and the range of the indexes.
+     * @param path is the file written by save.
+     * @throw std::runtime_error if the file can not be read.
+     * @throw std::invalid_argument if the file is not a compiled graph, it was written with another
+     *        byte order or word size, it is too large for this machine or it is inconsistent.
+     */
+    explicit compiled_graph(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) throw std::runtime_error("compiled_graph: can not open " + path);
+        in.seekg(0, std::ios::end);
+        const std::uint64_t size = static_cast<std::uint64_t>(in.tellg());
+        in.seekg(0, std::ios::beg);
+        if (size < sizeof(header)) throw std::invalid_argument("compiled_graph: file too short");
+        in.read(reinterpret_cast<char*>(&_header), sizeof(header));
+        if (_header.magic != file_magic || _header.byte_order != byte_order_mark){
+            throw std::invalid_argument(_header.byte_order == swapped_byte_order_mark
+                                        ? "compiled_graph: written with another byte order"
+                                        : "compiled_graph: bad magic number");
+        }
+        if (_header.word_size != sizeof(std::uint64_t)) throw std::invalid_argument("compiled_graph: bad word size");
+        const std::uint64_t max_words = size / sizeof(std::uint64_t);
+        if (_header.models >= max_words || _header.relays >= max_words || _header.external_inputs > max_words
+                || _header.couplings > max_words || _header.external_outputs > max_words){
+            throw std::invalid_argument("compiled_graph: bad file size");
+        }
+        const std::uint64_t nodes = _header.models + _header.relays;
+        const std::uint64_t words = _header.models + nodes + 1 + _header.external_inputs + _header.couplings + _header.external_outputs;
+        if (size != sizeof(header) + words * sizeof(std::uint64_t)) throw std::invalid_argument("compiled_graph: bad file size");
+        //indexes are kept in std::size_t by the flat_description
+        if (words > std::numeric_limits<std::size_t>::max() / sizeof(std::uint64_t)) throw std::invalid_argument("compiled_graph: graph too large for this machine");
+        read_words(in, _header.models, _tags);
+        read_words(in, _header.external_inputs, _external_inputs);
+        read_words(in, nodes + 1, _offsets);
+        read_words(in, _header.couplings, _targets);
+        read_words(in, _header.external_outputs, _external_outputs);
+        if (!in) throw std::runtime_error("compiled_graph: can not read " + path);
+        //a corrupted file should not make the coordinator read out of range
+        if (_offsets[0] != 0 || _offsets[nodes] != _header.couplings) throw std::invalid_argument("compiled_graph: bad coupling offsets");
+        for (std::uint64_t i = 0; i < nodes; i++){
+            if (_offsets[i] > _offsets[i + 1]) throw std::invalid_argument("compiled_graph: bad coupling offsets");
+        }
+        auto in_range = [](const std::size_t* first, const std::size_t* last, std::uint64_t n){
+            for (const std::size_t* i = first; i != last; i++){
+                if (*i >= n) return false;
+            }
+            return true;
+        };
+        //models send to models and relays, relays only to models
+        const std::size_t* relay_targets = _targets.data() + _offsets[_header.models];
+        if (!in_range(_external_inputs.data(), _external_inputs.data() + _external_inputs.size(), _header.models)
+                || !in_range(_targets.data(), relay_targets, nodes)
+                || !in_range(relay_targets, _targets.data() + _targets.size(), _header.models)
+                || !in_range(_external_outputs.data(), _external_outputs.data() + _external_outputs.size(), _header.models)){
+            throw std::invalid_argument("compiled_graph: model index out of range");
+        }
+    }
+
+    /**
+     * @brief models is the number of atomic models in the graph.
+     */
+    std::size_t models() const noexcept {
+        return _header.models;
+    }
+
+    /**
+     * @brief tag is the value saved for the model at index i, used by factories to know which model to create.
+     */
+    std::uint64_t tag(std::size_t i) const noexcept {
+        return _tags[i];
+    }
+
+    /**
+     * @brief bind creates the models with the factory and returns them coupled as saved.
+     * @param factory is called as factory(index, tag) for each index in order and returns a
+     *        std::shared_ptr to an atomic model derived of atomic<TIME, MSG>.
+     * @return a flattened_coupled ready to be coordinated.
+     * @throw std::invalid_argument if the factory returns a null model.
+     */
+    template<class TIME, class MSG, class FACTORY>
+    std::shared_ptr<flattened_coupled<TIME, MSG>> bind(FACTORY&& factory) const & {
+        auto flat = create_models<TIME, MSG>(factory);
+        flat.external_input_coupling = _external_inputs;
+        flat.coupling_offsets = _offsets;
+        flat.coupling_targets = _targets;
+        flat.external_output_coupling = _external_outputs;
+        return std::make_shared<flattened_coupled<TIME, MSG>>(std::move(flat));
+    }
+
+    /**
+     * @brief bind of a graph used only once moves the couplings to the flattened_coupled instead of copying them,
+     * the graph can not be bound again.
+     * @throw std::invalid_argument if the factory returns a null model, the graph is left as it was.
+     */
+    template<class TIME, class MSG, class FACTORY>
+    std::shared_ptr<flattened_coupled<TIME, MSG>> bind(FACTORY&& factory) && {
+        auto flat = create_models<TIME, MSG>(factory);
+        flat.external_input_coupling = std::move(_external_inputs);
+        flat.coupling_offsets = std::move(_offsets);
+        flat.coupling_targets = std::move(_targets);
+        flat.external_output_coupling = std::move(_external_outputs);
+        return std::make_shared<flattened_coupled<TIME, MSG>>(std::move(flat));
+    }
+
+    /**
+     * @brief save writes the flattened topology of a model in a file to be loaded by compiled_graph.
+     * @param fc is the flattened model, its coupled submodels were already resolved when it was constructed.
+     * @param path is the file to write, it is replaced if exists.
+     * @param tag_of is called as tag_of(index, model) and returns the std::uint64_t saved for the model.
+     * @return false if the file could not be written.
+     */
+    template<class TIME, class MSG, class TAG>
+    static bool save(const flattened_coupled<TIME, MSG>& fc, const std::string& path, TAG&& tag_of){
+        const auto& flat = fc.get_flat_description();
+        header h{file_magic, byte_order_mark, sizeof(std::uint64_t), flat.models.size(), flat.relays(), flat.external_input_coupling.size(), flat.coupling_targets.size(), flat.external_output_coupling.size()};
+        std::vector<std::uint64_t> tags(flat.models.size());
+        for (std::size_t i = 0; i < flat.models.size(); i++) tags[i] = tag_of(i, flat.models[i]);
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&h), sizeof(header));
+        write_words(out, tags);
+        write_words(out, flat.external_input_coupling);
+        write_words(out, flat.coupling_offsets);
+        write_words(out, flat.coupling_targets);
+        write_words(out, flat.external_output_coupling);
+        out.close();
+        return !out.fail();
+    }
+
+    /**
+     * @brief save writes the flattened topology with every tag set to zero.
+     */
+    template<class TIME, class MSG>
+    static bool save(const flattened_coupled<TIME, MSG>& fc, const std::string& path){
+        return save(fc, path, [](std::size_t, const std::shared_ptr<model<TIME>>&){ return std::uint64_t{0}; });
+    }
+};
+
+}
+}
+}
+
+#endif // BOOST_SIMULATION_PDEVS_COMPILED_GRAPH_H
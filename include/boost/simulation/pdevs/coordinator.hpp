@@ -28,11 +28,20 @@
 
 #ifndef BOOST_SIMULATION_PDEVS_COORDINATOR_H
 #define BOOST_SIMULATION_PDEVS_COORDINATOR_H
-#include <map>
+#include <unordered_map>
+#include <memory>
+#include <deque>
+#include <algorithm>
 #include <queue>
+#include <stdexcept>
 #include <cassert>
 
 #include <boost/simulation/pdevs/coupled.hpp>
+#include <boost/simulation/pdevs/simulator.hpp>
+#include <boost/simulation/pdevs/observers.hpp>
+#include <boost/simulation/pdevs/parallel.hpp>
+#include <boost/simulation/pdevs/simd.hpp>
+#include <boost/simulation/pdevs/reorder.hpp>
 #include <boost/any.hpp>
 
 namespace boost {
@@ -46,6 +55,582 @@ class nullqueue{
     //avoid using queues and run pooling time advance from models.
 };
 
+/**
+ * @brief The coordinator_base class has what all coordinators share, whatever the way they schedule their children:
+ * building the hierarchy and collapsing its couplings in direct routes, the stubs of lazy builds, routing the
+ * messages in the top level and collecting the outputs.
+ * COORDINATOR is the coordinator deriving from it, it provides init, transition and for_each_imminent_simulator.
+ */
+template<class TIME, class MSG, class COORDINATOR, template<class, class> class OBSERVER>
+class coordinator_base : public node<TIME, MSG, COORDINATOR>
+{
+public:
+    /**
+     * @brief parallel_threshold is the number of atomic models a coupled model needs to be built and initialized
+     * with threads, smaller models are done by a single thread before others would be started.
+     */
+    static constexpr std::size_t parallel_threshold = 4096;
+
+protected:
+    using node_type=node<TIME, MSG, COORDINATOR>;
+    using simulator_type=simulator<TIME, MSG, COORDINATOR, OBSERVER>;
+    using relay_type=relay<TIME, MSG, COORDINATOR>;
+    friend node_type;
+
+    //submodels, in the order of the coupled model description
+    std::vector<node_type*> _children;
+    std::vector<simulator_type> _simulators; //of the atomic submodels
+    std::vector<std::unique_ptr<COORDINATOR>> _coordinators; //of the coupled submodels
+    std::deque<relay_type> _relays; //of the couplings collapsed in this level, a deque so they never move
+    std::shared_ptr<coupled<TIME, MSG>> _coupled; // coupled model coordinated
+    std::shared_ptr<atomic<TIME, MSG>> _atomic; // atomic model simulated, if constructed from one
+    bool _stub = false; //built lazily, routes reaching its input end here and are forwarded
+    bool _dormant = false; //stub whose subtree is not built yet
+    bool _reorder = false; //simulators are stored by locality in the coupling graph, not in description order
+    bool _parallel = false; //large enough to be initialized with threads
+    std::vector<std::uint32_t> _receivers; //children with pending input that are not imminent
+    std::vector<node_type*> _input_leaves; //nodes receiving the input of this coordinator
+    std::vector<node_type*> _output_leaves; //nodes whose outputs are outputs of this coordinator
+    //infinity of current time representation
+    TIME infinity;
+    //caching output
+    int _processed_output = -1;
+    int _processed_advances = 0;
+    std::vector<MSG> _cached_out;
+
+    struct stub_tag{};
+
+    /**
+     * @brief coordinator_base of a coupled model, the derived coordinator builds the hierarchy once constructed.
+     */
+    coordinator_base(std::shared_ptr<coupled<TIME, MSG>> c, bool reorder) noexcept
+        : node_type(false), _coupled(c), _reorder(reorder), infinity(c->infinity)
+    {}
+
+    /**
+     * @brief coordinator_base of an atomic model, run by a single simulator connected to the input and the output.
+     */
+    explicit coordinator_base(std::shared_ptr<atomic<TIME, MSG>> a) noexcept
+        : node_type(false), _atomic(a), infinity(a->infinity)
+    {
+       _simulators.emplace_back(a.get());
+       simulator_type* sim = &_simulators.back();
+       sim->_parent = &derived();
+       sim->_to_out = true;
+       _children.push_back(sim);
+       _input_leaves.push_back(sim);
+       _output_leaves.push_back(sim);
+    }
+
+    /**
+     * @brief coordinator_base of a copy of the flattened model run by original, with a copy of each model in the same
+     * position. The simulators and relays are created in the storage order of the original and its routes are rebased
+     * to them, so no coupling is resolved and no order is computed again.
+     * @throw std::invalid_argument if original does not run a flattened model or copy has a different size.
+     */
+    coordinator_base(const COORDINATOR& original, std::shared_ptr<flattened_coupled<TIME, MSG>> copy)
+        : node_type(false), _coupled(copy), _reorder(original._reorder), _parallel(original._parallel), infinity(original.infinity)
+    {
+        auto source = std::dynamic_pointer_cast<flattened_coupled<TIME, MSG>>(original._coupled);
+        if (source == nullptr || original._stub || !original._coordinators.empty() || copy == nullptr){
+            throw std::invalid_argument("coordinator: only coordinators of flattened models can be copied");
+        }
+        const auto& from = source->get_flat_description();
+        const auto& to = copy->get_flat_description();
+        const std::size_t n = from.models.size();
+        if (to.models.size() != n || to.relays() != from.relays() || original._simulators.size() != n){
+            throw std::invalid_argument("coordinator: the copied model needs the size of the original one");
+        }
+        //position of the model of each simulator in the description, the storage position unless reordered
+        std::unordered_map<const model<TIME>*, std::size_t> position;
+        if (_reorder){
+            position.reserve(n);
+            for (std::size_t i = 0; i < n; i++) position.emplace(from.models[i].get(), i);
+        }
+        _simulators.reserve(n);
+        _children.reserve(n);
+        for (const simulator_type& sim : original._simulators){
+            std::size_t i = _reorder ? position.at(&sim.coordinated()) : _simulators.size();
+            atomic<TIME, MSG>* a = dynamic_cast<atomic<TIME, MSG>*>(to.models[i].get());
+            if (a == nullptr) throw std::invalid_argument("coordinator: the copied model needs atomic models in the positions of the original ones");
+            _simulators.emplace_back(a);
+            _children.push_back(&_simulators.back());
+        }
+        _relays.resize(original._relays.size());
+        auto rebase = [this](const node_type* n) -> node_type* {
+            return n->_relay ? static_cast<node_type*>(&_relays[n->_index]) : _children[n->_index];
+        };
+        auto copy_routes = [&rebase](const node_type& src, node_type& dst){
+            dst._routes.reserve(src._routes.size());
+            for (const node_type* r : src._routes) dst._routes.push_back(rebase(r));
+        };
+        for (std::size_t k = 0; k < n; k++){
+            const simulator_type& src = original._simulators[k];
+            simulator_type& dst = _simulators[k];
+            dst._parent = &derived();
+            dst._index = src._index;
+            dst._to_out = src._to_out;
+            copy_routes(src, dst);
+        }
+        for (std::size_t r = 0; r < _relays.size(); r++){
+            _relays[r]._index = static_cast<std::uint32_t>(r);
+            copy_routes(original._relays[r], _relays[r]);
+        }
+        _input_leaves.reserve(original._input_leaves.size());
+        for (const node_type* leaf : original._input_leaves) _input_leaves.push_back(rebase(leaf));
+        _output_leaves.reserve(original._output_leaves.size());
+        for (const node_type* leaf : original._output_leaves) _output_leaves.push_back(rebase(leaf));
+    }
+
+    coordinator_base(const coordinator_base&) = delete; //children point to their parent
+    coordinator_base& operator=(const coordinator_base&) = delete;
+
+    COORDINATOR& derived() noexcept { return static_cast<COORDINATOR&>(*this); }
+
+    //the children are simulators or coordinators, these functions dispatch to the right one
+    static void init_child(node_type* n, const TIME& t){
+        if (n->_leaf) static_cast<simulator_type*>(n)->init(t);
+        else static_cast<COORDINATOR*>(n)->init(t);
+    }
+
+    static void advance_child(node_type* n, const TIME& t) noexcept {
+        if (n->_leaf) static_cast<simulator_type*>(n)->transition(t);
+        else static_cast<COORDINATOR*>(n)->transition(t, nullptr);
+    }
+
+    static const model<TIME>& model_of(const node_type* n) noexcept {
+        if (n->_leaf) return static_cast<const simulator_type*>(n)->coordinated();
+        return static_cast<const COORDINATOR*>(n)->coordinated();
+    }
+
+    /**
+     * @brief outputs computes the output bag at _next only once per transition.
+     * The bag is reused by the top level for external output and routing.
+     */
+    const std::vector<MSG>& outputs() noexcept {
+        if (_processed_output == _processed_advances) return _cached_out; //already computed since last transition
+        _cached_out.clear();
+        derived().for_each_imminent_simulator([this](simulator_type& sim){
+            if (sim._to_out){
+                const std::vector<MSG>& tmp = sim.outputs();
+                _cached_out.insert(_cached_out.end(), tmp.begin(), tmp.end());
+            }
+        });
+        _processed_output = _processed_advances;
+        return _cached_out;
+    }
+
+    /**
+     * @brief coordinated returns the model handled by this coordinator, to be reported to observers.
+     */
+    const model<TIME>& coordinated() const noexcept {
+        return (_coupled != nullptr ? static_cast<const model<TIME>&>(*_coupled) : static_cast<const model<TIME>&>(*_atomic));
+    }
+
+    //nodes reached by messages sent to n, dormant stubs stand for their subtree
+    template<class FUNC>
+    static void for_each_input_node(node_type* n, FUNC&& f) noexcept {
+        if (n->_leaf || static_cast<COORDINATOR*>(n)->_dormant){
+            f(n);
+        } else {
+            for (node_type* leaf : static_cast<COORDINATOR*>(n)->_input_leaves) f(leaf);
+        }
+    }
+
+    //nodes whose outputs leave n
+    template<class FUNC>
+    static void for_each_output_node(node_type* n, FUNC&& f) noexcept {
+        if (n->_leaf || static_cast<COORDINATOR*>(n)->_dormant){
+            f(n);
+        } else {
+            for (node_type* leaf : static_cast<COORDINATOR*>(n)->_output_leaves) f(leaf);
+        }
+    }
+
+    //number of nodes for_each_input_node calls f on
+    static std::size_t input_nodes(node_type* n) noexcept {
+        if (n->_leaf || static_cast<COORDINATOR*>(n)->_dormant) return 1;
+        return static_cast<COORDINATOR*>(n)->_input_leaves.size();
+    }
+
+    //number of nodes for_each_output_node calls f on
+    static std::size_t output_nodes(node_type* n) noexcept {
+        if (n->_leaf || static_cast<COORDINATOR*>(n)->_dormant) return 1;
+        return static_cast<COORDINATOR*>(n)->_output_leaves.size();
+    }
+
+    //delivers a bag sent by the model from to dst, relays pass it to the nodes they route to
+    static void deliver(const model<TIME>& from, node_type* dst, const std::vector<MSG>& bag, const TIME& t) noexcept {
+        if (dst->_relay){
+            for (node_type* d : dst->_routes) deliver(from, d, bag, t);
+        } else {
+            dst->receive(bag, t);
+            OBSERVER<TIME, MSG>::route(from, model_of(dst), bag, t);
+        }
+    }
+
+    /**
+     * @brief route delivers the messages exchanged at t, only called in the top level.
+     * The external input goes to the simulators reached by the input of the coupled model and the
+     * outputs of the imminent simulators go through their direct routes, no intermediate level copies them.
+     */
+    void route(const TIME& t) noexcept {
+        if (!this->_inbox.empty()){
+            for (node_type* dst : _input_leaves){
+                dst->receive(this->_inbox, t);
+                OBSERVER<TIME, MSG>::route(coordinated(), model_of(dst), this->_inbox, t);
+            }
+        }
+        if (t == this->_next){
+            derived().for_each_imminent_simulator([&t](simulator_type& src){
+                if (src._routes.empty()) return;
+                const std::vector<MSG>& out = src.outputs();
+                if (out.empty()) return;
+                for (node_type* dst : src._routes) deliver(src.coordinated(), dst, out, t);
+            });
+        }
+    }
+
+    /**
+     * @brief begin_transition runs what every transition at t starts with: the outputs to the upper level are
+     * collected if eoc is provided, the inbox of a stub is forwarded and the top level routes the messages.
+     */
+    void begin_transition(const TIME& t, std::vector<MSG>* eoc) noexcept {
+        if (eoc != nullptr && t == this->_next){
+            *eoc = outputs(); //the output goes up
+        }
+        _processed_advances++; //invalidate cached output
+        if (_stub && !this->_inbox.empty()) forward(t);
+        this->_pending = false;
+        assert(t <= this->_next);
+        assert(t >= this->_last);
+        if (this->_parent == nullptr) route(t); //the top level delivers the messages of all levels
+        this->_last = t;
+    }
+
+    /**
+     * @brief init_children sets the start time of this coordinator and initializes its children.
+     * If the model is large, its children are initialized concurrently using init_threads, each subtree by
+     * a single thread, so threads are only started in the top level.
+     */
+    void init_children(const TIME& t, unsigned init_threads){
+        _processed_advances++; //invalidate cached output
+        this->_last = t;
+        this->_next = infinity;
+        parallel_for(_children.size(), _parallel ? init_threads : 1, [this, &t](std::size_t i, unsigned){
+            init_child(_children[i], t);
+        });
+    }
+
+    /**
+     * @brief storage_order returns the order the n atomic submodels are stored in, the description order unless reordering.
+     * Reordered, the ones coupled to each other are stored close and scheduled by their position in storage,
+     * so routing and the walks over the children touch less cache lines.
+     */
+    std::vector<std::uint32_t> storage_order(std::size_t n, const std::vector<std::pair<std::uint32_t, std::uint32_t>>& edges) const {
+        if (_reorder) return reverse_cuthill_mckee(n, edges);
+        std::vector<std::uint32_t> order(n);
+        for (std::size_t i = 0; i < n; i++) order[i] = static_cast<std::uint32_t>(i);
+        return order;
+    }
+
+    //inverse of an order, the position of each element in it
+    static std::vector<std::uint32_t> places(const std::vector<std::uint32_t>& order) noexcept {
+        std::vector<std::uint32_t> place(order.size());
+        for (std::size_t k = 0; k < order.size(); k++) place[order[k]] = static_cast<std::uint32_t>(k);
+        return place;
+    }
+
+    /**
+     * @brief collapse creates the simulators and the relays of a flattened model, its couplings are already routes between them.
+     */
+    void collapse(const typename flattened_coupled<TIME, MSG>::flat_description& flat){
+        const std::size_t n = flat.models.size();
+        _parallel = n >= parallel_threshold;
+        const std::size_t nodes = n + flat.relays();
+        assert(nodes <= UINT32_MAX);
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+        if (_reorder){
+            edges.reserve(flat.coupling_targets.size());
+            for (std::size_t i = 0; i < nodes; i++){
+                for (std::size_t k = flat.coupling_offsets[i]; k < flat.coupling_offsets[i + 1]; k++){
+                    edges.emplace_back(static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(flat.coupling_targets[k]));
+                }
+            }
+        }
+        //the children are in storage order, place maps each model to its child, relays are only ordered with them
+        std::vector<std::uint32_t> order = storage_order(nodes, edges);
+        order.erase(std::remove_if(order.begin(), order.end(), [n](std::uint32_t i){ return i >= n; }), order.end());
+        std::vector<std::uint32_t> place = places(order);
+        _simulators.reserve(n);
+        _children.reserve(n);
+        for (std::uint32_t i : order){
+            auto& m = flat.models[i];
+            assert((dynamic_cast<atomic<TIME, MSG>*>(m.get()) != nullptr));
+            _simulators.emplace_back(static_cast<atomic<TIME, MSG>*>(m.get()));
+            _children.push_back(&_simulators.back());
+        }
+        _relays.resize(nodes - n);
+        for (std::size_t r = 0; r < _relays.size(); r++) _relays[r]._index = static_cast<std::uint32_t>(r); //to rebase copies
+        auto node_of = [this, n, &place](std::size_t i) -> node_type* {
+            return i < n ? _children[place[i]] : &_relays[i - n];
+        };
+        for (std::size_t i = 0; i < nodes; i++){
+            node_type* src = node_of(i);
+            if (i < n){
+                src->_parent = &derived();
+                src->_index = place[i];
+            }
+            for (std::size_t k = flat.coupling_offsets[i]; k < flat.coupling_offsets[i + 1]; k++){
+                assert((i < n || flat.coupling_targets[k] < n) && "Relays only forward to atomic models");
+                src->_routes.push_back(node_of(flat.coupling_targets[k]));
+            }
+        }
+        for (std::size_t in : flat.external_input_coupling){
+            _input_leaves.push_back(_children[place[in]]);
+        }
+        for (std::size_t out : flat.external_output_coupling){
+            _children[place[out]]->_to_out = true;
+            _output_leaves.push_back(_children[place[out]]);
+        }
+    }
+
+    /**
+     * @brief build creates the coordinators and simulators of the submodels and collapses the couplings of all levels.
+     * If lazy, coupled submodels whose atomic models are all passive are replaced by stubs, expanded on first input.
+     * If reordering, the simulators of each level are stored following the internal couplings between them.
+     * Threads are only used if the model is large and only in this level, each subtree is built by a single thread.
+     */
+    void build(unsigned build_threads, bool lazy){
+       if (auto flat = dynamic_cast<flattened_coupled<TIME, MSG>*>(_coupled.get())){
+           collapse(flat->get_flat_description());
+           return;
+       }
+       const auto& desc = _coupled->get_description();
+       const std::size_t n = desc.models.size();
+       assert(n <= UINT32_MAX);
+       //a single cast tells which submodels are atomic
+       std::vector<atomic<TIME, MSG>*> atomics(n);
+       parallel_for(n, n >= parallel_threshold ? build_threads : 1, [&desc, &atomics](std::size_t p, unsigned){
+           atomics[p] = dynamic_cast<atomic<TIME, MSG>*>(desc.models[p].get());
+       });
+       std::unordered_map<const model<TIME>*, std::uint32_t> position; //submodel address to its position
+       position.reserve(n);
+       for (std::size_t p = 0; p < n; p++){
+           position.emplace(desc.models[p].get(), static_cast<std::uint32_t>(p));
+       }
+       auto position_of = [&position](const std::shared_ptr<model<TIME>>& m){
+           auto it = position.find(m.get());
+           assert(it != position.end()); //couplings only refer to submodels
+           return it->second;
+       };
+       //simulators are stored contiguously, coupled submodels are built after
+       _children.resize(n);
+       std::vector<std::size_t> coupled_positions;
+       std::vector<std::uint32_t> atomic_positions;
+       std::vector<std::uint32_t> rank(n); //position of each atomic submodel among the atomic ones
+       for (std::size_t p = 0; p < n; p++){
+           if (atomics[p] == nullptr){
+               coupled_positions.push_back(p);
+           } else {
+               rank[p] = static_cast<std::uint32_t>(atomic_positions.size());
+               atomic_positions.push_back(static_cast<std::uint32_t>(p));
+           }
+       }
+       std::vector<std::pair<std::uint32_t, std::uint32_t>> edges; //internal couplings between atomic submodels
+       if (_reorder){
+           for (auto& ic : desc.internal_coupling){
+               std::uint32_t from = position_of(ic.first), to = position_of(ic.second);
+               if (atomics[from] != nullptr && atomics[to] != nullptr) edges.emplace_back(rank[from], rank[to]);
+           }
+       }
+       //the children are in description order or, if reordering, the atomic ones in storage order followed by the coupled ones
+       std::vector<std::uint32_t> order(n);
+       if (_reorder){
+           std::size_t k = 0;
+           for (std::uint32_t r : storage_order(atomic_positions.size(), edges)) order[k++] = atomic_positions[r];
+           for (std::size_t p : coupled_positions) order[k++] = static_cast<std::uint32_t>(p);
+       } else {
+           for (std::size_t p = 0; p < n; p++) order[p] = static_cast<std::uint32_t>(p);
+       }
+       std::vector<std::uint32_t> place = places(order);
+       _simulators.reserve(atomic_positions.size());
+       for (std::size_t k = 0; k < n; k++){
+           if (atomics[order[k]] == nullptr) continue;
+           _simulators.emplace_back(atomics[order[k]]);
+           _children[k] = &_simulators.back();
+       }
+       //the models of the coupled submodels are counted one level down, enough to tell small models from large ones
+       std::size_t size = atomic_positions.size();
+       for (std::size_t p : coupled_positions) size += size_of(static_cast<coupled<TIME, MSG>&>(*desc.models[p]));
+       _parallel = size >= parallel_threshold;
+       //coupled submodels are independent subtrees, built concurrently if threads are given and the model is large
+       _coordinators.resize(coupled_positions.size());
+       parallel_for(coupled_positions.size(), _parallel ? build_threads : 1, [this, &desc, &coupled_positions, &place, lazy](std::size_t k, unsigned){
+           std::size_t p = coupled_positions[k];
+           auto& m = desc.models[p];
+           assert((dynamic_cast<coupled<TIME, MSG>*>(m.get()) != nullptr));
+           std::shared_ptr<coupled<TIME, MSG>> m_coupled(m, static_cast<coupled<TIME, MSG>*>(m.get()));
+           auto& co = _coordinators[k];
+           if (lazy && passive(*m_coupled)){ //a stub stands for the subtree until it receives input
+               co.reset(new COORDINATOR(m_coupled, stub_tag{}));
+               co->_stub = true;
+               co->_dormant = true;
+               co->_reorder = _reorder;
+           } else {
+               co.reset(new COORDINATOR(m_coupled, 1, lazy, _reorder));
+           }
+           _children[place[p]] = co.get();
+       });
+       //merging the subtrees in this level
+       for (std::size_t p = 0; p < n; p++){
+           _children[p]->_parent = &derived();
+           _children[p]->_index = static_cast<std::uint32_t>(p);
+       }
+       auto container_of = [this, &position_of, &place](const std::shared_ptr<model<TIME>>& m){
+           return _children[place[position_of(m)]];
+       };
+       //internal couplings of this level become routes from the nodes leaving the source to the ones reached in destination,
+       //a destination reaching many nodes from many sources gets a relay, so the routes do not grow as their product
+       std::vector<node_type*> relay_of(n, nullptr);
+       for (auto& ic : desc.internal_coupling){
+           node_type* from = container_of(ic.first);
+           node_type* to = container_of(ic.second);
+           node_type*& relay = relay_of[to->_index];
+           if (relay == nullptr && input_nodes(to) > 1 && output_nodes(from) > 1){
+               _relays.emplace_back();
+               relay = &_relays.back();
+               for_each_input_node(to, [relay](node_type* dst){ relay->_routes.push_back(dst); });
+           }
+           if (relay != nullptr){
+               for_each_output_node(from, [relay](node_type* src){ src->_routes.push_back(relay); });
+           } else {
+               for_each_output_node(from, [to](node_type* src){
+                   for_each_input_node(to, [src](node_type* dst){ src->_routes.push_back(dst); });
+               });
+           }
+       }
+       //external_input_coupling
+       for (auto& a : desc.external_input_coupling){
+           for_each_input_node(container_of(a), [this](node_type* dst){ _input_leaves.push_back(dst); });
+       }
+       //external_output_coupling, the _to_out flag is only kept for the top level
+       std::vector<bool> connected_to_out(n, false);
+       for (auto& m : desc.external_output_coupling){
+           connected_to_out[container_of(m)->_index] = true;
+       }
+       for (node_type* child : _children){
+           bool to_out = connected_to_out[child->_index];
+           for_each_output_node(child, [this, to_out](node_type* src){
+               src->_to_out = to_out;
+               if (to_out) _output_leaves.push_back(src);
+           });
+       }
+       //submodels were collapsed in this level
+       for (auto& co : _coordinators){
+           std::vector<node_type*>().swap(co->_input_leaves);
+           std::vector<node_type*>().swap(co->_output_leaves);
+       }
+    }
+
+    /**
+     * @brief size_of is the number of models in the level of c, atomic models if it is flattened.
+     */
+    static std::size_t size_of(coupled<TIME, MSG>& c){
+        if (auto flat = dynamic_cast<flattened_coupled<TIME, MSG>*>(&c)) return flat->get_flat_description().models.size();
+        return c.get_description().models.size();
+    }
+
+    /**
+     * @brief passive tells if every atomic model below c starts with an infinite time advance.
+     */
+    static bool passive(coupled<TIME, MSG>& c) noexcept {
+        if (auto flat = dynamic_cast<flattened_coupled<TIME, MSG>*>(&c)){
+            for (auto& m : flat->get_flat_description().models){
+                if (static_cast<atomic<TIME, MSG>&>(*m).advance() != c.infinity) return false;
+            }
+            return !flat->get_flat_description().models.empty();
+        }
+        const auto& desc = c.get_description();
+        for (auto& m : desc.models){
+            if (atomic<TIME, MSG>* m_atomic = dynamic_cast<atomic<TIME, MSG>*>(m.get())){
+                if (m_atomic->advance() != c.infinity) return false;
+            } else if (!passive(static_cast<coupled<TIME, MSG>&>(*m))){
+                return false;
+            }
+        }
+        return !desc.models.empty();
+    }
+
+    /**
+     * @brief expand builds the subtree of a dormant stub, its simulators are initialized at the time the stub was.
+     * The routes and the output flag collected by the stub go to the nodes sending its output.
+     */
+    void expand() noexcept {
+        _dormant = false;
+        std::vector<node_type*> routes;
+        routes.swap(this->_routes);
+        bool to_out = this->_to_out;
+        this->_to_out = false;
+        build(1, true);
+        for (node_type* src : _output_leaves){
+            src->_to_out = to_out;
+            src->_routes.insert(src->_routes.end(), routes.begin(), routes.end());
+        }
+        std::vector<node_type*>().swap(_output_leaves);
+        derived().init(this->_last);
+    }
+
+    /**
+     * @brief forward delivers the inbox of a stub to the nodes reached by its input, expanding it the first time.
+     * The stub is still pending or imminent, so the receivers below it do not schedule it again.
+     */
+    void forward(const TIME& t) noexcept {
+        if (_dormant) expand();
+        for (node_type* dst : _input_leaves){
+            dst->receive(this->_inbox, t);
+            OBSERVER<TIME, MSG>::route(coordinated(), model_of(dst), this->_inbox, t);
+        }
+    }
+
+public:
+    /**
+     * @brief advanceSimulation advances the execution to t, at t introduces the messages into the system (if any).
+     * @param t is the time the transition is expected to be run.
+     * @return the time until next internal event.
+     */
+    void advanceSimulation(const TIME& t) noexcept { //bag of input was collected in _inbox internal var.
+        derived().transition(t, nullptr);
+    }
+
+    /**
+     * @brief step runs the transition at t and collects the outputs to the upper level in the same pass.
+     * It is equivalent to call collectOutputs followed by advanceSimulation, walking the imminents once.
+     * @param t is the time the transition is expected to be run.
+     * @return the bag of output messages at t.
+     */
+    std::vector<MSG> step(const TIME& t) noexcept {
+        std::vector<MSG> vm;
+        derived().transition(t, &vm);
+        return vm;
+    }
+
+    /**
+     * @brief collectOutputs provides the output of the coordinated model at t.
+     * Outputs are cached, calling it many times for the same transition runs out() once.
+     * @param t is the time the outputs are requested.
+     * @return the bag of output messages, empty if t is not the next transition time.
+     */
+    std::vector<MSG> collectOutputs(const TIME& t) noexcept {
+        if (this->_next != t) return {}; //not my turn
+
+        return outputs(); //cached until next transition
+    }
+};
+
+template<class TIME, class MSG, class COORDINATOR, template<class, class> class OBSERVER>
+constexpr std::size_t coordinator_base<TIME, MSG, COORDINATOR, OBSERVER>::parallel_threshold;
+
 /**
  * @brief The Coordinator class runs a PDEVS coupled model
  * The Coordinators are used to run the coupled models.
@@ -57,388 +642,254 @@ class nullqueue{
  * There is never a rollback.
  * Each call to advanceSimulation advances internally a step and outputs are collected in separate method.
  * Time and Message are the representations for time and message, FEL is the structure to represent Future Event List
+ * Atomic submodels are run by simulators, small nodes stored contiguously in the coordinator of their level.
  */
 
-//FEL needs a anything with the same operations as std::priority_queue<std::pair<TIME, std::shared_ptr<PCoordinator<TIME, MSG, FEL>>>
+//FEL needs a anything with the same operations as std::priority_queue<std::pair<TIME, std::uint32_t>>
 template <class VALUE_TYPE, class COMPARE_TYPE>
 using priority_queue_vector = std::priority_queue<VALUE_TYPE, std::vector<VALUE_TYPE>, COMPARE_TYPE>;
 
-template<class TIME, class MSG, template<class, class> class FEL=nullqueue>//nullqueue FEL means no structure and pool from models.
-class coordinator
+template<class TIME, class MSG, template<class, class> class FEL=nullqueue, //nullqueue FEL means no structure and pool from models.
+         template<class, class> class OBSERVER=null_observer> //null_observer has no cost, see observers.hpp for others.
+class coordinator : public coordinator_base<TIME, MSG, coordinator<TIME, MSG, FEL, OBSERVER>, OBSERVER>
 {
    //We assume that FEL interface is compatible to queue.h interface for now.
    //also we assume there is not cheap way to do the removal of elements when changing schedule in a model.
 
-    TIME _last; //last transition time
-    TIME _next; // next transition scheduled
-    //used when coordinating
-    std::vector<std::shared_ptr<coordinator<TIME, MSG, FEL>>> _subcoordinators;
-    //used when simulating
-    std::shared_ptr<atomic<TIME, MSG>> _model; // atomic model simulated
-    //coupling in this coordinator
-    std::vector<std::shared_ptr<coordinator<TIME, MSG, FEL>>> _external_input_coupling;
-    //couplings from uplevel coordinator
-    bool _is_connected_to_out; //tell if connected to output of the next level coupled model.
-    std::vector<std::shared_ptr<coordinator<TIME, MSG, FEL>>> _internal_connections; // tell what models are the message going in the next level coupled.
-    //infinity of current time representation
-    TIME infinity;
-    //_inbox next level model puts here what will be consumed in next advanceSimulation call
-    std::vector<MSG> _inbox;
-    //Future Event List
-    using FEL_ITEM_TYPE = std::pair<TIME, std::shared_ptr<coordinator<TIME, MSG, FEL>>>;
+    using base_type=coordinator_base<TIME, MSG, coordinator, OBSERVER>;
+    using typename base_type::node_type;
+    using typename base_type::simulator_type;
+    using typename base_type::stub_tag;
+    friend base_type;
+    using base_type::_children;
+    using base_type::infinity;
+    using base_type::_reorder;
+    using base_type::advance_child;
+
+    //Future Event List, children are referred by their position
+    using FEL_ITEM_TYPE = std::pair<TIME, std::uint32_t>;
     using FEL_COMP_TYPE = bool(*)( const FEL_ITEM_TYPE &lhs, const FEL_ITEM_TYPE &rhs);
-    FEL<FEL_ITEM_TYPE, FEL_COMP_TYPE> _fel;
+    static bool later(const FEL_ITEM_TYPE &lhs, const FEL_ITEM_TYPE &rhs) noexcept { return lhs.first > rhs.first; }
+    FEL<FEL_ITEM_TYPE, FEL_COMP_TYPE> _fel{&later};
 
-    std::vector<std::shared_ptr<coordinator<TIME, MSG, FEL>>> _inminents;
+    std::vector<std::uint32_t> _inminents;
+
+    /**
+     * @brief for_each_imminent_simulator calls f on every simulator below this coordinator scheduled at _next.
+     */
+    template<class FUNC>
+    void for_each_imminent_simulator(FUNC&& f) noexcept {
+        for (std::uint32_t i : _inminents){
+            node_type* n = _children[i];
+            if (n->_leaf){
+                f(*static_cast<simulator_type*>(n));
+            } else {
+                static_cast<coordinator*>(n)->for_each_imminent_simulator(f);
+            }
+        }
+    }
+
+    /**
+     * @brief Coordinator of a stub, nothing below it is built until expand is called.
+     */
+    coordinator(std::shared_ptr<coupled<TIME, MSG>> c, stub_tag) noexcept : base_type(c, false) {}
 public:
     coordinator() = delete;
+    coordinator(const coordinator&) = delete; //children point to their parent
+    coordinator& operator=(const coordinator&) = delete;
     /**
      * @brief Coordinator constructs from an PCoupled model.
+     * The couplings of all levels are collapsed in direct routes between the simulators,
+     * coordinators of the coupled submodels only schedule their children.
      * @param a pointer to the Coupled model simulated.
+     * @param build_threads is the number of threads used to build the coordinators of the submodels, only used
+     *        for models of at least parallel_threshold atomic models.
+     * @param lazy tells to replace the coupled submodels starting passive by stubs, built the first time they receive input.
+     * @param reorder tells to store the simulators coupled to each other close in memory, using reverse Cuthill-McKee.
      */
-    explicit coordinator(std::shared_ptr<coupled<TIME, MSG>> c) noexcept
-        : _model(nullptr), _is_connected_to_out(false), _internal_connections(), infinity(c->infinity)
+    explicit coordinator(std::shared_ptr<coupled<TIME, MSG>> c, unsigned build_threads=1, bool lazy=false, bool reorder=false)
+        : base_type(c, reorder)
     {
-       //initialize FEL
-       auto FELcomp = [](const FEL_ITEM_TYPE &lhs, const FEL_ITEM_TYPE &rhs){ return lhs.first > rhs.first ; };
-       _fel = FEL<FEL_ITEM_TYPE, FEL_COMP_TYPE>(FELcomp);
-
-
-       // from here on similar in all specializations
-       auto desc = c->get_description();
-       std::map<void*, std::shared_ptr<coordinator<TIME, MSG, FEL>>> model_to_container; //using void* to only check address match
-       for (auto& m : desc.models){
-           bool to_external_out;
-           //is current model connected to output?
-           to_external_out = false;
-           if(std::any_of(desc.external_output_coupling.begin(),
-                          desc.external_output_coupling.end(),
-                          [&m](std::shared_ptr<model<TIME>>& eoc){
-                                return eoc ==  m; }
-                          )){
-                                to_external_out = true;
-                            }
-           //create coordinators and simulators
-           std::shared_ptr<atomic<TIME, MSG>> m_atomic = std::dynamic_pointer_cast<atomic<TIME, MSG>>(m);
-           std::shared_ptr<coupled<TIME, MSG>> m_coupled = std::dynamic_pointer_cast<coupled<TIME, MSG>>(m);
-
-           if (m_atomic == nullptr){
-               assert(m_coupled != nullptr);
-               auto coord = std::make_shared<coordinator<TIME, MSG, FEL>>(m_coupled);
-               coord->_is_connected_to_out=to_external_out;
-               _subcoordinators.push_back(coord);
-               model_to_container.emplace((void*) m.get(), coord );
-           } else {
-               auto sim = std::make_shared<coordinator<TIME, MSG, FEL>>(m_atomic);
-               sim->_is_connected_to_out=to_external_out;
-               _subcoordinators.push_back(sim);
-               model_to_container.emplace((void*) m.get(), sim );
-           }
-       }
-       //remap interconnections
-       //internal connections
-       for (auto& m : desc.models){
-           std::vector<std::shared_ptr<coordinator<TIME, MSG, FEL>>> to_internals;
-           to_internals.clear();
-           for (auto& ints : desc.internal_coupling){
-
-               if (ints.first.get() ==  m.get()){
-                   //inserting destination
-                   std::shared_ptr<atomic<TIME, MSG>> int_sec_atomic = std::dynamic_pointer_cast<atomic<TIME, MSG>>(ints.second);
-                   std::shared_ptr<coupled<TIME, MSG>> int_sec_coupled = std::dynamic_pointer_cast<coupled<TIME, MSG>>(ints.second);
-
-                   if(int_sec_atomic == nullptr){ //coupled model destination
-                       assert(int_sec_coupled != nullptr);
-                       to_internals.push_back(model_to_container[int_sec_coupled.get()]);
-                   } else { //destination atomic
-                       to_internals.push_back(model_to_container[int_sec_atomic.get()]);
-                   }
-               }
-           }
-           //assigning
-            model_to_container[m.get()]->_internal_connections = to_internals;
-       }
-       //external_input_coupling
-       for (auto& a : desc.external_input_coupling){
-            _external_input_coupling.push_back( model_to_container[a.get()] );
-       }
+       this->build(build_threads, lazy);
     }
 
     /**
      * @brief Coordinator for simulation constructs from an PAtomic model.
+     * The model is run by a single simulator connected to the input and the output of the coordinator.
      * @param a pointer to the Atomic model simulated.
      */
-    explicit coordinator(std::shared_ptr<atomic<TIME, MSG>> a) noexcept : _model(a), infinity(a->infinity) {}
+    explicit coordinator(std::shared_ptr<atomic<TIME, MSG>> a) noexcept : base_type(a) {}
 
     /**
-     * @brief Coordinator expected next internal transition time
+     * @brief Coordinator of a copy of the flattened model run by original, as the instances of a prototype.
+     * The simulators, relays and routes are copied from original and rebased to the models of the copy.
+     * @throw std::invalid_argument if original does not run a flattened model or copy has a different size.
      */
-    TIME next() const noexcept {
-        return _next;
-    }
+    coordinator(const coordinator& original, std::shared_ptr<flattened_coupled<TIME, MSG>> copy) : base_type(original, copy) {}
 
     /**
      * @brief init function sets the start time
      * @param t is the start time
+     * @param init_threads is the number of threads used to init the submodels, only used for models of at least
+     *        parallel_threshold atomic models.
      * @return the time until first time advance result
      */
-    TIME init(TIME t) noexcept {
-        _last = t;
-        //init all submodels and find next transition time
-        _next = infinity;
-        if (_model != nullptr){ //if need to simulate a model
-            _next = _last + _model->advance();
-        } else { //if need to run a pure coordinator
-            //init submodles and queue them if next internal event is not infinity
-            for ( auto& c: _subcoordinators){
-                TIME next = c->init(t);
-                if (next < _next) _next = next;
-                if (next != infinity) _fel.emplace(next, c);
-            }
+    TIME init(TIME t, unsigned init_threads=1){
+        this->init_children(t, init_threads);
+        //queue them if next internal event is not infinity
+        for (node_type* c : _children){
+            TIME next = c->_next;
+            if (next < this->_next) this->_next = next;
+            if (next != infinity) _fel.emplace(next, c->_index);
         }
         //setup inminents
-        while(!_fel.empty() && _fel.top().first == _next){
+        while(!_fel.empty() && _fel.top().first == this->_next){
+            _children[_fel.top().second]->_imminent = true;
             _inminents.push_back(_fel.top().second);
             _fel.pop();
         }
+        if (_reorder) std::sort(_inminents.begin(), _inminents.end()); //walked in storage order
 
-        return _next;
+        return this->_next;
     }
+private:
     /**
-     * @brief advanceSimulation advances the execution to t, at t introduces the messages into the system (if any).
-     * @param t is the time the transition is expected to be run.
-     * @return the time until next internal event.
+     * @brief transition runs the transition at t, if eoc is provided the outputs to the upper level are appended to it.
      */
-    void advanceSimulation(const TIME& t) noexcept { //bag of input was collected in _inbox internal var.
-        //if model is simulated in this coordinator
-    	// For debug purposes only
-    	/*
-    	SWO_PrintString((_model->asString()).c_str());
-    	SWO_PrintString(" - Advance Execution Call \n");
-    	*/
-        if (_model != nullptr){
-            assert(t >= _last);
-            assert(t <= _next );
-            if (_inbox.empty()){
-                if (t == _next){
-                    _model->internal();
-                    _last = t;
-                    _next = _last + _model->advance();
-                } else {
-                    _last = t;
-                }
-            } else {
-                if ( t == _next){ //confluence
-                    _model->confluence(_inbox, t-_last);
-                    _last = t;
-                    _next = _last + _model->advance();
-                } else { //external
-                    _model->external(_inbox, t-_last);
-                    _last = t;
-                    _next = _last + _model->advance();
-                }
-            }
-        } else {  //if coordinator is pure and no model is simulated
-            assert(t <= _next);
-            assert(t >= _last);
-            _last = t;
-            //std::vector<std::shared_ptr<PCoordinator<TIME, MSG, FEL>>> inminents_internal;
-            std::vector<std::shared_ptr<coordinator<TIME, MSG, FEL>>> inminents_external;
-            //processing external input into _inboxes
-            for (auto& receiver : _external_input_coupling){
-                    if (receiver->next() != _last && receiver->_inbox.size() == 0){
-                        inminents_external.push_back(receiver);
-                    }
-                    receiver->_inbox.insert(receiver->_inbox.end(), _inbox.begin(), _inbox.end());
+    void transition(const TIME& t, std::vector<MSG>* eoc) noexcept { //bag of input was collected in _inbox internal var.
+        this->begin_transition(t, eoc);
+        //processing inminents
+        if (t == this->_next){
+            for (std::uint32_t i : _inminents){
+                node_type* n = _children[i];
+                n->_imminent = false;
+                advance_child(n, t);
+                if (n->_next != infinity) _fel.emplace(n->_next, i);
             }
-            //collecting inputs and adding inminents models for internal transitions
-            if (_last == _next) {
-                for (auto& co : _inminents){
-                    if (co->_internal_connections.size()){
-                        std::vector<MSG> out = co->collectOutputs(_last);
-                        for (auto& receiver : co->_internal_connections){
-                            if (receiver->next() != _last && receiver->_inbox.size() == 0){
-                                inminents_external.push_back(receiver);
-                            }
-                            receiver->_inbox.insert(receiver->_inbox.end(), out.begin(), out.end());
-                        }
-                    }
-                }
-            }
-            //processing inminents
-            for (auto& co : _inminents){
-                co->advanceSimulation(t);
-                if (co->next() != infinity) _fel.emplace(co->next(), co);
-            }
-            for (auto& co : inminents_external){
-                co->advanceSimulation(t);
-                if (co->next() != infinity) _fel.emplace(co->next(), co);
+        } else { //inminents keep waiting for _next
+            for (std::uint32_t i : _inminents){
+                _children[i]->_imminent = false;
+                _fel.emplace(this->_next, i);
             }
-            //setting up next variable
-            _next = infinity;
-            //consuming the queue, skip the replaced events
-            while (_next == infinity && !_fel.empty()){
-                if (_fel.top().first == _fel.top().second->next()){
-                    _next = _fel.top().first;
-                } else {
-                    _fel.pop();
-                }
+        }
+        //processing children with input, their event in the FEL is still valid if next did not change
+        for (std::uint32_t i : this->_receivers){
+            node_type* n = _children[i];
+            TIME before = n->_next;
+            advance_child(n, t);
+            if (n->_next != before && n->_next != infinity) _fel.emplace(n->_next, i);
+        }
+        this->_receivers.clear();
+        //setting up next variable
+        this->_next = infinity;
+        //consuming the queue, skip the replaced events
+        while (this->_next == infinity && !_fel.empty()){
+            if (_fel.top().first == _children[_fel.top().second]->_next){
+                this->_next = _fel.top().first;
+            } else {
+                _fel.pop();
             }
         }
-        _inbox.clear();
+        this->_inbox.clear();
         //setup next inminents
         _inminents.clear();
-        while(!_fel.empty() && _fel.top().first == _next){
-            if (_fel.top().second->next() == _next){
+        while(!_fel.empty() && _fel.top().first == this->_next){
+            node_type* n = _children[_fel.top().second];
+            if (n->_next == this->_next && !n->_imminent){ //skip replaced and repeated events
+                n->_imminent = true;
                 _inminents.push_back(_fel.top().second);
             }
             _fel.pop();
         }
+        if (_reorder) std::sort(_inminents.begin(), _inminents.end()); //walked in storage order
 
     }
+};
 
-    std::vector<MSG> collectOutputs(const TIME& t) noexcept {
-    	// For debug purposes only
-    	/*
-    	SWO_PrintString((_model->asString()).c_str());
-    	SWO_PrintString(" - Collect Outputs Call \n");
-        */
-        if (_next != t) return {}; //not my turn
 
-        if (_model != nullptr){ return _model->out(); } //atomic model
+//specialiazation for pooling to models in place of using a FEL.
+template<class TIME, class MSG, template<class, class> class OBSERVER>
+class coordinator<TIME, MSG, nullqueue, OBSERVER> : public coordinator_base<TIME, MSG, coordinator<TIME, MSG, nullqueue, OBSERVER>, OBSERVER>
+{
+    using base_type=coordinator_base<TIME, MSG, coordinator, OBSERVER>;
+    using typename base_type::node_type;
+    using typename base_type::simulator_type;
+    using typename base_type::stub_tag;
+    friend base_type;
+    using base_type::_children;
+    using base_type::infinity;
+    using base_type::advance_child;
 
-        //if coordinator of coupled model
-        std::vector<MSG> vm;
-        for (auto& co : _inminents){
-            if (co->next() == t && co->_is_connected_to_out){
-                std::vector<MSG> tmp = co->collectOutputs(t);
-                vm.insert(vm.end(), tmp.begin(), tmp.end());
+    std::vector<TIME> _nexts; //next transition of each child, contiguous to scan them with vector instructions
+
+    /**
+     * @brief for_each_imminent_simulator calls f on every simulator below this coordinator scheduled at _next.
+     */
+    template<class FUNC>
+    void for_each_imminent_simulator(FUNC&& f) noexcept {
+        for_each_equal(_nexts.data(), _nexts.size(), this->_next, [this, &f](std::size_t i){
+            node_type* n = _children[i];
+            if (n->_leaf){
+                f(*static_cast<simulator_type*>(n));
+            } else {
+                static_cast<coordinator*>(n)->for_each_imminent_simulator(f);
             }
-        }
-        return vm;
+        });
     }
 
-};
-
-
-//specialiazation for pooling to models in place of using a FEL.
-template<class TIME, class MSG>
-class coordinator<TIME, MSG, nullqueue>
-{
-    TIME _last; //last transition time
-    TIME _next; // next transition scheduled
-    //used when coordinating
-    std::vector<std::shared_ptr<coordinator<TIME, MSG, nullqueue>>> _subcoordinators;
-    //used when simulating
-    std::shared_ptr<atomic<TIME, MSG>> _model; // atomic model simulated
-    //coupling in this coordinator
-    std::vector<std::shared_ptr<coordinator<TIME, MSG, nullqueue>>> _external_input_coupling;
-    //couplings from uplevel coordinator
-    bool _is_connected_to_out; //tell if connected to output of the next level coupled model.
-    std::vector<std::shared_ptr<coordinator<TIME, MSG, nullqueue>>> _internal_connections; // tell what models are the message going in the next level coupled.
-    //infinity of current time representation
-    TIME infinity;
-    //_inbox next level model puts here what will be consumed in next advanceSimulation call
-    std::vector<MSG> _inbox;
-    //caching output
-    int _processed_output = 0;
-    int _processed_advances = 0;
-    std::vector<MSG> _cached_out;
+    /**
+     * @brief Coordinator of a stub, nothing below it is built until expand is called.
+     */
+    coordinator(std::shared_ptr<coupled<TIME, MSG>> c, stub_tag) noexcept : base_type(c, false) {}
 public:
     coordinator() = delete;
+    coordinator(const coordinator&) = delete; //children point to their parent
+    coordinator& operator=(const coordinator&) = delete;
     /**
      * @brief Coordinator constructs from an PCoupled model.
+     * The couplings of all levels are collapsed in direct routes between the simulators,
+     * coordinators of the coupled submodels only schedule their children.
      * @param a pointer to the Coupled model simulated.
+     * @param build_threads is the number of threads used to build the coordinators of the submodels, only used
+     *        for models of at least parallel_threshold atomic models.
+     * @param lazy tells to replace the coupled submodels starting passive by stubs, built the first time they receive input.
+     * @param reorder tells to store the simulators coupled to each other close in memory, using reverse Cuthill-McKee.
      */
-    explicit coordinator(std::shared_ptr<coupled<TIME, MSG>> c) noexcept
-        : _model(nullptr), _is_connected_to_out(false), _internal_connections(), infinity(c->infinity)
+    explicit coordinator(std::shared_ptr<coupled<TIME, MSG>> c, unsigned build_threads=1, bool lazy=false, bool reorder=false)
+        : base_type(c, reorder)
     {
-       auto desc = c->get_description();
-       std::map<void*, std::shared_ptr<coordinator<TIME, MSG, nullqueue>>> model_to_container; //using void* to only check address match
-       for (auto& m : desc.models){
-           bool to_external_out;
-           //is current model connected to output?
-           to_external_out = false;
-           if(std::any_of(desc.external_output_coupling.begin(),
-                          desc.external_output_coupling.end(),
-                          [&m](std::shared_ptr<model<TIME>>& eoc){
-                                return eoc ==  m; }
-                          )){
-                                to_external_out = true;
-                            }
-           //create coordinators and simulators
-           std::shared_ptr<atomic<TIME, MSG>> m_atomic = std::dynamic_pointer_cast<atomic<TIME, MSG>>(m);
-           std::shared_ptr<coupled<TIME, MSG>> m_coupled = std::dynamic_pointer_cast<coupled<TIME, MSG>>(m);
-           if ( m_atomic == nullptr){
-               assert(m_coupled != nullptr);
-               auto coord = std::make_shared<coordinator<TIME, MSG, nullqueue>>(m_coupled);
-               coord->_is_connected_to_out=to_external_out;
-               _subcoordinators.push_back(coord);
-               model_to_container.emplace((void*) m_coupled.get(), coord );
-           } else {
-               auto sim = std::make_shared<coordinator<TIME, MSG, nullqueue>>(m_atomic);
-               sim->_is_connected_to_out=to_external_out;
-               _subcoordinators.push_back(sim);
-               model_to_container.emplace((void*) m_atomic.get(), sim );
-           }
-       }
-       //remap interconnections
-       //internal connections
-       for (auto& m : desc.models){
-           std::vector<std::shared_ptr<coordinator<TIME, MSG, nullqueue>>> to_internals;
-           to_internals.clear();
-           for (auto& ints : desc.internal_coupling){
-               if (ints.first.get() ==  m.get() ){
-                   //inserting destination
-                   std::shared_ptr<atomic<TIME, MSG>> int_sec_atomic = std::dynamic_pointer_cast<atomic<TIME, MSG>>(ints.second);
-                   std::shared_ptr<coupled<TIME, MSG>> int_sec_coupled = std::dynamic_pointer_cast<coupled<TIME, MSG>>(ints.second);
-                   if(int_sec_atomic == nullptr){ //coupled model destination
-                       assert(int_sec_coupled != nullptr);
-                       to_internals.push_back(model_to_container[int_sec_coupled.get()]);
-                   } else { //destination atomic
-                       to_internals.push_back(model_to_container[int_sec_atomic.get()]);
-                   }
-               }
-           }
-           //assigning
-           model_to_container[m.get()]->_internal_connections = to_internals;
-       }
-       //external_input_coupling
-       for (auto& a : desc.external_input_coupling){
-           _external_input_coupling.push_back( model_to_container[a.get()] );
-       }
+       this->build(build_threads, lazy);
     }
 
     /**
      * @brief Coordinator for simulation constructs from an PAtomic model.
+     * The model is run by a single simulator connected to the input and the output of the coordinator.
      * @param a pointer to the Atomic model simulated.
      */
-    explicit coordinator(std::shared_ptr<atomic<TIME, MSG>> a) noexcept : _model(a), infinity(a->infinity) {}
+    explicit coordinator(std::shared_ptr<atomic<TIME, MSG>> a) noexcept : base_type(a) {}
+
     /**
-     * @brief Coordinator expected next internal transition time
+     * @brief Coordinator of a copy of the flattened model run by original, as the instances of a prototype.
+     * The simulators, relays and routes are copied from original and rebased to the models of the copy.
+     * @throw std::invalid_argument if original does not run a flattened model or copy has a different size.
      */
-    TIME next() const noexcept {
-        return _next;
-    }
+    coordinator(const coordinator& original, std::shared_ptr<flattened_coupled<TIME, MSG>> copy) : base_type(original, copy) {}
 
     /**
      * @brief init function sets the start time
      * @param t is the start time
+     * @param init_threads is the number of threads used to init the submodels, only used for models of at least
+     *        parallel_threshold atomic models.
      * @return the time until first time advance result
      */
-    TIME init(TIME t) noexcept {
-        _last = t;
-        //init all submodels and find next transition time.
-        _next = infinity;
-        if (_model != nullptr){ //if need to simulate a model
-            _next = _last + _model->advance();
-        } else { //if need to run a pure coordinator
-            for ( auto& c: _subcoordinators){
-                TIME next = c->init(t);
-                if (next < _next) _next = next;
-            }
+    TIME init(TIME t, unsigned init_threads=1){
+        this->init_children(t, init_threads);
+        _nexts.resize(_children.size());
+        for (std::size_t i = 0; i < _children.size(); i++){
+            _nexts[i] = _children[i]->_next;
         }
-        return _next;
+        this->_next = min_time(_nexts.data(), _nexts.size(), infinity);
+        return this->_next;
     }
     /**
      * @brief postHardwareEvent adds a message to the inbox of a coordinator. This action is too be triggered by the runner.
@@ -446,119 +897,34 @@ public:
      * @return void.
      */
     void postHardwareEvent(MSG m)noexcept{
-    	_inbox.push_back(m); // considering we are pushing one event now (Embedded CD-Boost)
+    	this->_inbox.push_back(m); // considering we are pushing one event now (Embedded CD-Boost)
     }
+private:
     /**
-     * @brief advanceSimulation advances the execution to t, at t introduces the messages into the system (if any).
-     * @param t is the time the transition is expected to be run.
-     * @return the time until next internal event.
+     * @brief transition runs the transition at t, if eoc is provided the outputs to the upper level are appended to it.
      */
-    void advanceSimulation(const TIME& t) noexcept { //bag of input was collected in _inbox internal var.
-    	// For debug purposes only
-    	//SWO_PrintString(" - advance_execution()::");
-
-        _processed_advances++; //invalidate cached output
-        //if model is atomic - this is a simulator -> Execute Simulator algos
-        if (_model != nullptr){
-        	_model->print();
-            assert(t >= _last);
-            assert(t <= _next );
-            if (_inbox.empty()){
-                if (t == _next){
-                    _model->internal();
-                    _last = t;
-                    _next = _last + _model->advance();
-                    //SWO_PrintString(("\t model->internal() model->advance(): " + _model->advance().asString() + " \n").c_str());
-                } else {
-//                    throw std::exception();
-                    _last = t;
-                }
-            } else {
-                if ( t == _next){ //confluence
-                    _model->confluence(_inbox, t-_last);
-                    _last = t;
-                    _next = _last + _model->advance();
-                    //SWO_PrintString("\t model->confluent() model->advance() \n");
-                } else { //external
-                    _model->external(_inbox, t-_last);
-                    _last = t;
-                    _next = _last + _model->advance();
-                    //SWO_PrintString(("\t model->external() model->advance(): " + _model->advance().asString() + " \n").c_str());
-                }
-            }
-        } else {  ////if model is coupled- this is a pure coordinator -> Execute Coordinator algos
-            assert(t <= _next);
-            assert(t >= _last);
-            _last = t;
-            std::vector<std::shared_ptr<coordinator<TIME, MSG, nullqueue>>> inminents_internal;
-            std::vector<std::shared_ptr<coordinator<TIME, MSG, nullqueue>>> inminents_external;
-            //processing external input into _inboxes
-            for (auto& receiver : _external_input_coupling){
-                    if (receiver->next() != _last && receiver->_inbox.size() == 0){ // was == 0
-                        inminents_external.push_back(receiver);
-                    }
-                    receiver->_inbox.insert(receiver->_inbox.end(), _inbox.begin(), _inbox.end());
-            }
-            //collecting inputs and adding inminents models for internal transitions
-            if (_last == _next) {
-                for (auto& co : _subcoordinators){
-                    if (co->next() == _next){//has internal waiting
-                        inminents_internal.push_back(co);
-                        if (co->_internal_connections.size()){
-                            std::vector<MSG> out = co->collectOutputs(_last);
-                            for (auto& receiver : co->_internal_connections){
-                                    if (receiver->next() != _last && receiver->_inbox.size() == 0){
-                                        inminents_external.push_back(receiver);
-                                    }
-                                    receiver->_inbox.insert(receiver->_inbox.end(), out.begin(), out.end());
-                            }
-                        }
-                    }
-                }
-            }
-            //processing inminents
-            for (auto& co : inminents_internal){
-                co->advanceSimulation(t);
-            }
-            for (auto& co : inminents_external){
-                co->advanceSimulation(t);
-
-            }
-            //setting up next variable
-            auto next_coord = std::min_element(_subcoordinators.begin(), _subcoordinators.end(),
-                                     [](std::shared_ptr<coordinator>& pc1, std::shared_ptr<coordinator>& pc2){ return pc1->next() < pc2->next();});
-            _next = (*next_coord)->next();
+    void transition(const TIME& t, std::vector<MSG>* eoc) noexcept { //bag of input was collected in _inbox internal var.
+        this->begin_transition(t, eoc);
+        //processing inminents
+        if (t == this->_next){
+            for_each_equal(_nexts.data(), _nexts.size(), t, [this, &t](std::size_t i){
+                advance_child(_children[i], t);
+                _nexts[i] = _children[i]->_next;
+            });
         }
-        _inbox.clear();
-    }
-
-    std::vector<MSG> collectOutputs(const TIME& t) noexcept {
-    	// For debug purposes only
-    	// SWO_PrintString(" - collect_outputs()::");
-
-        if (_next != t) return {}; //not my turn
-
-        //SWO_PrintString(" - collect_outputs()::");
-        if (_model != nullptr){
-        	/*_model->print(); SWO_PrintString("\t model->out() \n");*/
-        	return _model->out();
-        } //atomic model
-        //else { SWO_PrintString("flattop \n");}
-
-        //if coordinator of coupled model
-        std::vector<MSG> vm;
-        for (auto& co : _subcoordinators){
-            if (co->next() == t && co->_is_connected_to_out){
-                std::vector<MSG> tmp = co->collectOutputs(t);
-                vm.insert(vm.end(), tmp.begin(), tmp.end());
-            }
+        //processing children with input
+        for (std::uint32_t i : this->_receivers){
+            advance_child(_children[i], t);
+            _nexts[i] = _children[i]->_next;
         }
-        return vm;
+        this->_receivers.clear();
+        //setting up next variable
+        this->_next = min_time(_nexts.data(), _nexts.size(), infinity);
+        this->_inbox.clear();
     }
 
 };
 
-
 }
 }
 }
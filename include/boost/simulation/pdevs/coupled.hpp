@@ -27,6 +27,12 @@
 
 #ifndef BOOST_SIMULATION_PDEVS_COUPLED_H
 #define BOOST_SIMULATION_PDEVS_COUPLED_H
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <stdexcept>
+#include <cassert>
 #include <boost/simulation/pdevs/atomic.hpp>
 #include <boost/simulation/model.hpp>
 
@@ -92,8 +98,10 @@ public:
     /**
      * @brief get_description provides the model in a way a coordinator
      * can read to construct the simulation hierarchy.
+     * The description is returned by reference, it lives as long as the coupled model.
+     * It is not noexcept, derived models may build the description when it is requested.
      */
-    coupled_description get_description() noexcept {
+    virtual const coupled_description& get_description() {
         //this is a good place for an assert that whole model is properly constructed
         return _desc;
     }
@@ -104,169 +112,242 @@ public:
 
 /**
  * @brief The flattened_coupled class represents a coupled model PDEVS that has a single level
+ * The coupled models received are flattened recursively to any depth in one pass, reading their descriptions
+ * by reference. The result is kept as a flat_description: the atomic models, the indexes of the ones
+ * connected to the external input and output, and the internal couplings as a compressed sparse row
+ * adjacency of indexes. The description of shared_ptr pairs is only built if get_description is called.
+ * A coupled submodel reached from many atomic models gets a relay, a node forwarding to the atomic models
+ * reached by its input, so coupling m senders to n receivers takes m + n entries in place of m * n.
  */
 template<class TIME, class MSG>
 class flattened_coupled : public coupled<TIME, MSG>
 {
 public:
     /**
-     * @brief Coupled receives the whole coupled model spec
-     * Each time a couple model is received it is exploted and put its components in current level.
+     * @brief The flat_description struct describes the flattened model using indexes to the atomic models.
+     * The couplings are between nodes, the atomic models followed by the relays: relay r is the node
+     * models.size() + r. The nodes receiving the output of node i are the ones indexed by coupling_targets
+     * in the range [coupling_offsets[i], coupling_offsets[i+1]). Relays only forward to atomic models.
      */
-    flattened_coupled(std::initializer_list<std::shared_ptr<model<TIME>>> models,
-            std::initializer_list<std::shared_ptr<model<TIME>>> eic,
-            std::initializer_list<std::pair<std::shared_ptr<model<TIME>>, std::shared_ptr<model<TIME>>>> ic,
-            std::initializer_list<std::shared_ptr<model<TIME>>> eoc
-                          ) noexcept : coupled<TIME, MSG>({}, {}, {}, {})
-    {
-        for ( auto& model : models){
-            std::shared_ptr<coupled<TIME, MSG>> m_coupled = std::dynamic_pointer_cast<coupled<TIME, MSG>>(model);
-            if ( m_coupled == nullptr){ //an atomic
-                coupled<TIME, MSG>::_desc.models.push_back(model);
-            } else { //a coupled
-                //inserting internal models
-                for (auto& submodel : m_coupled->get_description().models){
-                    coupled<TIME, MSG>::_desc.models.push_back(submodel);
-                }
-                //mantaining internal coups in submodels
-                for (auto& subic : m_coupled->get_description().internal_coupling){
-                    coupled<TIME, MSG>::_desc.internal_coupling.push_back(subic);
+    struct flat_description{
+        std::vector<std::shared_ptr<model<TIME>>> models; //only atomic models
+        std::vector<std::size_t> external_input_coupling;
+        std::vector<std::size_t> coupling_offsets; //one more than nodes
+        std::vector<std::size_t> coupling_targets;
+        std::vector<std::size_t> external_output_coupling;
+
+        /**
+         * @brief relays is the number of nodes after the atomic models.
+         */
+        std::size_t relays() const noexcept {
+            return coupling_offsets.size() - 1 - models.size();
+        }
+    };
+
+private:
+    using models_type=std::vector<std::shared_ptr<model<TIME>>>;
+    using couplings_type=std::vector<std::pair<std::shared_ptr<model<TIME>>, std::shared_ptr<model<TIME>>>>;
+    using edge=std::pair<std::size_t, std::size_t>;
+    //atomic models reached by the input and sending to the output of a flattened level
+    struct level_ends{
+        std::vector<std::size_t> inputs;
+        std::vector<std::size_t> outputs;
+    };
+
+    //edges refer to relays with this bit set until the number of models is known
+    static constexpr std::size_t relay_bit = ~(~std::size_t(0) >> 1);
+
+    flat_description _flat;
+    std::size_t _relays = 0; //relays found while flattening
+    std::once_flag _described; //pairs description was built from _flat, once even if requested by many threads
+
+    /**
+     * @brief flatten appends the atomic models of a level to _flat and its internal couplings to edges.
+     * Coupled submodels are flattened recursively, then each coupling of the level is replaced by the
+     * couplings from the atomic models sending through its source to the atomic models reached in its destination.
+     * If many of them send to a coupled submodel reaching many atomic models, they send to a relay instead.
+     * @throw std::invalid_argument if a model is null or a coupling refers to a model not in the level.
+     */
+    level_ends flatten(const models_type& models, const models_type& eic, const couplings_type& ic, const models_type& eoc, std::vector<edge>& edges){
+        std::unordered_map<const model<TIME>*, std::size_t> position; //of the models in this level
+        position.reserve(models.size());
+        std::vector<std::size_t> atomic_index(models.size()); //for atomic submodels
+        std::vector<level_ends> coupled_ends(models.size()); //for coupled submodels, empty for atomic ones
+        std::vector<bool> is_atomic(models.size(), false);
+        for (std::size_t p = 0; p < models.size(); p++){
+            model<TIME>* m = models[p].get();
+            if (m == nullptr) throw std::invalid_argument("flattened_coupled: null model");
+            position.emplace(m, p);
+            if (flattened_coupled* m_flat = dynamic_cast<flattened_coupled*>(m)){ //already flat, relocate its indexes
+                coupled_ends[p] = append(m_flat->_flat, edges);
+            } else if (coupled<TIME, MSG>* m_coupled = dynamic_cast<coupled<TIME, MSG>*>(m)){
+                const auto& desc = m_coupled->get_description();
+                coupled_ends[p] = flatten(desc.models, desc.external_input_coupling, desc.internal_coupling, desc.external_output_coupling, edges);
+            } else {
+                is_atomic[p] = true;
+                atomic_index[p] = _flat.models.size();
+                _flat.models.push_back(models[p]);
+            }
+        }
+        auto inputs_of = [&](std::size_t p, std::vector<std::size_t>& to){
+            if (is_atomic[p]) to.push_back(atomic_index[p]);
+            else to.insert(to.end(), coupled_ends[p].inputs.begin(), coupled_ends[p].inputs.end());
+        };
+        auto outputs_of = [&](std::size_t p, std::vector<std::size_t>& to){
+            if (is_atomic[p]) to.push_back(atomic_index[p]);
+            else to.insert(to.end(), coupled_ends[p].outputs.begin(), coupled_ends[p].outputs.end());
+        };
+        auto position_of = [&position](const std::shared_ptr<model<TIME>>& m){
+            auto it = position.find(m.get());
+            if (it == position.end()) throw std::invalid_argument("flattened_coupled: couplings can only refer to models of their level");
+            return it->second;
+        };
+        //internal couplings
+        std::vector<std::size_t> relay_of(models.size(), 0); //relay of each coupled submodel plus one, 0 if none
+        std::vector<std::size_t> sources, targets;
+        for (auto& coupling : ic){
+            std::size_t from = position_of(coupling.first), to = position_of(coupling.second);
+            sources.clear();
+            targets.clear();
+            outputs_of(from, sources);
+            if (!is_atomic[to] && coupled_ends[to].inputs.size() > 1 && (relay_of[to] != 0 || sources.size() > 1)){
+                if (relay_of[to] == 0){
+                    relay_of[to] = ++_relays;
+                    for (std::size_t t : coupled_ends[to].inputs) edges.emplace_back(relay_bit | (relay_of[to] - 1), t);
                 }
+                targets.push_back(relay_bit | (relay_of[to] - 1));
+            } else {
+                inputs_of(to, targets);
+            }
+            for (std::size_t s : sources){
+                for (std::size_t t : targets) edges.emplace_back(s, t);
             }
         }
+        level_ends result;
         //connecting input links
         for (auto& in : eic){
-            std::shared_ptr<coupled<TIME, MSG>> m_coupled = std::dynamic_pointer_cast<coupled<TIME, MSG>>(in);
-            if ( m_coupled == nullptr){ //an atomic
-                coupled<TIME, MSG>::_desc.external_input_coupling.push_back(in);
-            } else {
-                for (auto& subin : m_coupled->get_description().external_input_coupling){
-                    coupled<TIME, MSG>::_desc.external_input_coupling.push_back(subin);
-                }
-            }
+            inputs_of(position_of(in), result.inputs);
         }
-        //connecting output links
+        //connecting output links, each submodel sends its output once
+        std::vector<bool> connected_to_out(models.size(), false);
         for (auto& out : eoc){
-            std::shared_ptr<coupled<TIME, MSG>> m_coupled = std::dynamic_pointer_cast<coupled<TIME, MSG>>(out);
-            if ( m_coupled == nullptr){ //an atomic
-                coupled<TIME, MSG>::_desc.external_output_coupling.push_back(out);
-            } else {
-                for (auto& subout : m_coupled->get_description().external_output_coupling){
-                    coupled<TIME, MSG>::_desc.external_output_coupling.push_back(subout);
-                }
-            }
+            std::size_t p = position_of(out);
+            if (!connected_to_out[p]) outputs_of(p, result.outputs);
+            connected_to_out[p] = true;
         }
-        //connecting internal links
-        for (auto& coupling : ic){
-            std::shared_ptr<coupled<TIME, MSG>> m_left = std::dynamic_pointer_cast<coupled<TIME, MSG>>(coupling.first);
-            std::shared_ptr<coupled<TIME, MSG>> m_right = std::dynamic_pointer_cast<coupled<TIME, MSG>>(coupling.second);
-            if ( m_left == nullptr){ //left is an atomic
-                if (m_right == nullptr) { //and right is an atomic
-                    coupled<TIME, MSG>::_desc.internal_coupling.push_back(coupling);
-                } else { //and right is a coupled
-                    for (auto& right_in : m_right->get_description().external_input_coupling){
-                        coupled<TIME, MSG>::_desc.internal_coupling.push_back({coupling.first, right_in});
-                    }
-                }
-            } else { // left is a coupled
-                if (m_right == nullptr){ //and right is atomic
-                    for (auto& subout : m_left->get_description().external_output_coupling){
-                        coupled<TIME, MSG>::_desc.internal_coupling.push_back({subout, m_right});
-                    }
-                } else { // and right is coupled
-                    for (auto& left_out : m_left->get_description().external_output_coupling){
-                        for (auto& right_in : m_right->get_description().external_input_coupling){
-                            coupled<TIME, MSG>::_desc.internal_coupling.push_back({left_out, right_in});
-                        }
-                    }
-                }
-            }
+        return result;
+    }
 
+    /**
+     * @brief append copies an already flattened model into _flat, its indexes are moved after the current models
+     * and its relays after the current relays.
+     */
+    level_ends append(const flat_description& flat, std::vector<edge>& edges){
+        std::size_t offset = _flat.models.size();
+        std::size_t n = flat.models.size();
+        auto relocate = [this, offset, n](std::size_t i){ return i < n ? offset + i : relay_bit | (_relays + i - n); };
+        _flat.models.insert(_flat.models.end(), flat.models.begin(), flat.models.end());
+        for (std::size_t i = 0; i + 1 < flat.coupling_offsets.size(); i++){
+            for (std::size_t k = flat.coupling_offsets[i]; k < flat.coupling_offsets[i + 1]; k++){
+                edges.emplace_back(relocate(i), relocate(flat.coupling_targets[k]));
+            }
         }
+        _relays += flat.relays();
+        level_ends result;
+        for (std::size_t in : flat.external_input_coupling) result.inputs.push_back(offset + in);
+        for (std::size_t out : flat.external_output_coupling) result.outputs.push_back(offset + out);
+        return result;
     }
+
+    //sorts the edges by source in the compressed sparse row arrays, the relays are numbered after the models
+    void compress(const std::vector<edge>& edges){
+        const std::size_t n = _flat.models.size();
+        auto node = [n](std::size_t i){ return (i & relay_bit) ? n + (i & ~relay_bit) : i; };
+        _flat.coupling_offsets.assign(n + _relays + 1, 0);
+        for (auto& e : edges) _flat.coupling_offsets[node(e.first) + 1]++;
+        for (std::size_t i = 0; i < n + _relays; i++) _flat.coupling_offsets[i + 1] += _flat.coupling_offsets[i];
+        _flat.coupling_targets.resize(edges.size());
+        std::vector<std::size_t> next(_flat.coupling_offsets.begin(), _flat.coupling_offsets.end() - 1);
+        for (auto& e : edges) _flat.coupling_targets[next[node(e.first)]++] = node(e.second);
+    }
+
+public:
+    /**
+     * @brief Coupled receives the whole coupled model spec
+     * Each time a couple model is received it is exploted and put its components in current level.
+     * @throw std::invalid_argument if a model is null or a coupling refers to a model not in its level.
+     */
+    flattened_coupled(std::initializer_list<std::shared_ptr<model<TIME>>> models,
+            std::initializer_list<std::shared_ptr<model<TIME>>> eic,
+            std::initializer_list<std::pair<std::shared_ptr<model<TIME>>, std::shared_ptr<model<TIME>>>> ic,
+            std::initializer_list<std::shared_ptr<model<TIME>>> eoc
+                          )
+        : flattened_coupled(models_type(models), models_type(eic), couplings_type(ic), models_type(eoc))
+    {}
     /**
      * @brief Coupled receives the whole coupled model spec
      * Each time a couple model is received it is exploted and put its components in current level.
      * The difference with the other constructor is the use of vectors in place of initilizer_lists
      * for the case where the initializer_list can not be constructed (because using dynamic construction or MS compiler).
+     * @throw std::invalid_argument if a model is null or a coupling refers to a model not in its level.
      */
     flattened_coupled(std::vector<std::shared_ptr<model<TIME>>> models,
             std::vector<std::shared_ptr<model<TIME>>> eic,
             std::vector<std::pair<std::shared_ptr<model<TIME>>, std::shared_ptr<model<TIME>>>> ic,
             std::vector<std::shared_ptr<model<TIME>>> eoc
-             ) noexcept : coupled<TIME, MSG>({}, {}, {}, {})
+             ) : coupled<TIME, MSG>(models_type{}, models_type{}, couplings_type{}, models_type{})
     {
-        for ( auto& model : models){
-            std::shared_ptr<coupled<TIME, MSG>> m_coupled = std::dynamic_pointer_cast<coupled<TIME, MSG>>(model);
-            if ( m_coupled == nullptr){ //an atomic
-                coupled<TIME, MSG>::_desc.models.push_back(model);
-            } else { //a coupled
-                //inserting internal models
-                for (auto& submodel : m_coupled->get_description().models){
-                    coupled<TIME, MSG>::_desc.models.push_back(submodel);
-                }
-                //mantaining internal coups in submodels
-                for (auto& subic : m_coupled->get_description().internal_coupling){
-                    coupled<TIME, MSG>::_desc.internal_coupling.push_back(subic);
-                }
-            }
-        }
-        //connecting input links
-        for (auto& in : eic){
-            std::shared_ptr<coupled<TIME, MSG>> m_coupled = std::dynamic_pointer_cast<coupled<TIME, MSG>>(in);
-            if ( m_coupled == nullptr){ //an atomic
-                coupled<TIME, MSG>::_desc.external_input_coupling.push_back(in);
-            } else {
-                for (auto& subin : m_coupled->get_description().external_input_coupling){
-                    coupled<TIME, MSG>::_desc.external_input_coupling.push_back(subin);
-                }
-            }
-        }
-        //connecting output links
-        for (auto& out : eoc){
-            std::shared_ptr<coupled<TIME, MSG>> m_coupled = std::dynamic_pointer_cast<coupled<TIME, MSG>>(out);
-            if ( m_coupled == nullptr){ //an atomic
-                coupled<TIME, MSG>::_desc.external_output_coupling.push_back(out);
-            } else {
-                for (auto& subout : m_coupled->get_description().external_output_coupling){
-                    coupled<TIME, MSG>::_desc.external_output_coupling.push_back(subout);
-                }
-            }
-        }
-        //connecting internal links
-        for (auto& coupling : ic){
-            std::shared_ptr<coupled<TIME, MSG>> m_left = std::dynamic_pointer_cast<coupled<TIME, MSG>>(coupling.first);
-            std::shared_ptr<coupled<TIME, MSG>> m_right = std::dynamic_pointer_cast<coupled<TIME, MSG>>(coupling.second);
-            if ( m_left == nullptr){ //left is an atomic
-                if (m_right == nullptr) { //and right is an atomic
-                    coupled<TIME, MSG>::_desc.internal_coupling.push_back(coupling);
-                } else { //and right is a coupled
-                    for (auto& right_in : m_right->get_description().external_input_coupling){
-                        coupled<TIME, MSG>::_desc.internal_coupling.push_back({coupling.first, right_in});
-                    }
-                }
-            } else { // left is a coupled
-                if (m_right == nullptr){ //and right is atomic
-                    for (auto& subout : m_left->get_description().external_output_coupling){
-                        coupled<TIME, MSG>::_desc.internal_coupling.push_back({subout, m_right});
-                    }
-                } else { // and right is coupled
-                    for (auto& left_out : m_left->get_description().external_output_coupling){
-                        for (auto& right_in : m_right->get_description().external_input_coupling){
-                            coupled<TIME, MSG>::_desc.internal_coupling.push_back({left_out, right_in});
-                        }
-                    }
-                }
-            }
+        std::vector<edge> edges;
+        level_ends ends = flatten(models, eic, ic, eoc, edges);
+        _flat.external_input_coupling = std::move(ends.inputs);
+        _flat.external_output_coupling = std::move(ends.outputs);
+        compress(edges);
+    }
 
-        }
+    /**
+     * @brief flattened_coupled receives a model already flattened, as the ones bound from a compiled_graph.
+     * No coupling is resolved, the indexes are expected to be in range of the models.
+     */
+    explicit flattened_coupled(flat_description flat) noexcept
+        : coupled<TIME, MSG>(models_type{}, models_type{}, couplings_type{}, models_type{}), _flat(std::move(flat))
+    {
+        assert(_flat.coupling_offsets.size() >= _flat.models.size() + 1);
+        _relays = _flat.relays();
     }
+
     /**
-     * @brief get_description provides the model in a way a coordinator
-     * can read to construct the simulation hierarchy.
+     * @brief get_flat_description provides the flattened model using indexes, coordinators read it in place of get_description.
      */
-    typename coupled<TIME, MSG>::coupled_description get_description() noexcept {
-        return coupled<TIME, MSG>::_desc;
+    const flat_description& get_flat_description() const noexcept {
+        return _flat;
+    }
+
+    /**
+     * @brief get_description provides the flattened model as pairs of pointers, built the first time it is requested.
+     * Pairs have no relays, each model sending to a relay is paired with every model the relay reaches.
+     * Building the pairs allocates, threads requesting them concurrently wait for the one building them.
+     */
+    const typename coupled<TIME, MSG>::coupled_description& get_description() override {
+        auto& desc = coupled<TIME, MSG>::_desc;
+        std::call_once(_described, [this, &desc](){
+            const std::size_t n = _flat.models.size();
+            desc.models = _flat.models;
+            for (std::size_t in : _flat.external_input_coupling) desc.external_input_coupling.push_back(_flat.models[in]);
+            for (std::size_t i = 0; i < n; i++){
+                for (std::size_t k = _flat.coupling_offsets[i]; k < _flat.coupling_offsets[i + 1]; k++){
+                    std::size_t t = _flat.coupling_targets[k];
+                    if (t < n){
+                        desc.internal_coupling.emplace_back(_flat.models[i], _flat.models[t]);
+                    } else {
+                        for (std::size_t r = _flat.coupling_offsets[t]; r < _flat.coupling_offsets[t + 1]; r++){
+                            desc.internal_coupling.emplace_back(_flat.models[i], _flat.models[_flat.coupling_targets[r]]);
+                        }
+                    }
+                }
+            }
+            for (std::size_t out : _flat.external_output_coupling) desc.external_output_coupling.push_back(_flat.models[out]);
+        });
+        return desc;
     }
 
 };
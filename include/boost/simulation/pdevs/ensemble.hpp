@@ -0,0 +1,109 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BOOST_SIMULATION_PDEVS_ENSEMBLE_H
+#define BOOST_SIMULATION_PDEVS_ENSEMBLE_H
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <boost/simulation/pdevs/atomic_array.hpp>
+
+namespace boost {
+namespace simulation {
+namespace pdevs {
+
+/**
+ * @brief The ensemble class runs K replications, the lanes, of a model of M elements in lockstep.
+ *
+ * The model is described once, as the couplings between its M elements, and the KERNEL keeps the state
+ * of the M x K elements in columns with the lanes interleaved: element e of lane l has index e * K + l,
+ * so the same element of all the lanes is contiguous. Lanes with the same event times share every step,
+ * their imminent elements run the internal transition in a single call to the KERNEL over contiguous
+ * indexes. Lanes diverging in time only run their own transitions, the others wait for their time:
+ * while few lanes share the steps, the lanes are scheduled by their earliest next transition and a step
+ * only scans the elements of the lanes due and of the lanes receiving messages.
+ * Each lane has its own state, so random streams and results are per lane, see atomic_array for KERNEL.
+ *
+ * The input of the ensemble goes to every lane and the output is the output of all the lanes, the KERNEL
+ * tells the lane of an output from the index of the element.
+ */
+template<class KERNEL>
+class ensemble : public atomic_array<KERNEL>
+{
+    std::size_t _lanes;
+
+    static std::vector<std::uint32_t> replicate(const std::vector<std::uint32_t>& elements, std::size_t lanes){
+        std::vector<std::uint32_t> all;
+        all.reserve(elements.size() * lanes);
+        for (std::uint32_t e : elements){
+            for (std::size_t l = 0; l < lanes; l++) all.push_back(index(e, l, lanes));
+        }
+        return all;
+    }
+
+    static std::vector<std::pair<std::uint32_t, std::uint32_t>> replicate(const std::vector<std::pair<std::uint32_t, std::uint32_t>>& couplings, std::size_t lanes){
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> all;
+        all.reserve(couplings.size() * lanes);
+        for (auto& c : couplings){
+            for (std::size_t l = 0; l < lanes; l++) all.emplace_back(index(c.first, l, lanes), index(c.second, l, lanes));
+        }
+        return all;
+    }
+
+public:
+    /**
+     * @brief ensemble constructor.
+     *
+     * @param kernel state and transition functions of the elements of all the lanes, interleaved.
+     * @param lanes number of replications.
+     * @param eic elements of a replication receiving the input.
+     * @param ic couplings between the elements of a replication.
+     * @param eoc elements of a replication whose outputs are output.
+     */
+    ensemble(KERNEL kernel, std::size_t lanes, const std::vector<std::uint32_t>& eic,
+             const std::vector<std::pair<std::uint32_t, std::uint32_t>>& ic,
+             const std::vector<std::uint32_t>& eoc) noexcept
+        : atomic_array<KERNEL>(std::move(kernel), lanes, replicate(eic, lanes), replicate(ic, lanes), replicate(eoc, lanes)), _lanes(lanes) {}
+
+    /**
+     * @brief lanes returns the number of replications.
+     */
+    std::size_t lanes() const noexcept { return _lanes; }
+    /**
+     * @brief index returns the index in the kernel of element e of lane l, with the lanes interleaved.
+     */
+    static std::uint32_t index(std::uint32_t e, std::size_t l, std::size_t lanes) noexcept {
+        return static_cast<std::uint32_t>(e * lanes + l);
+    }
+};
+
+}
+}
+}
+
+#endif // BOOST_SIMULATION_PDEVS_ENSEMBLE_H
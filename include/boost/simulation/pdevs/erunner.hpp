@@ -49,11 +49,11 @@ namespace pdevs {
  * conditions, the ending conditions and the loggers, then it runs the simulation and
  * displays the results.
  */
-template <class TIME, class MSG, template<class, class> class FEL=nullqueue>
+template <class TIME, class MSG, template<class, class> class FEL=nullqueue, template<class, class> class OBSERVER=null_observer>
 class erunner
 {
     TIME _next; //next scheduled event
-    std::shared_ptr<coordinator<TIME, MSG, nullqueue>> _coordinator; //ecoordinator of the top level coupled model.
+    std::shared_ptr<coordinator<TIME, MSG, nullqueue, OBSERVER>> _coordinator; //ecoordinator of the top level coupled model.
     std::shared_ptr<driver<TIME, MSG>> _driver; // global driver to manage top ports connected to hardware
     std::vector<std::pair<std::shared_ptr<port<TIME,MSG>>, std::shared_ptr<model<TIME>>>> _input_ports;
     std::vector<std::pair<std::shared_ptr<port<TIME,MSG>>, std::shared_ptr<model<TIME>>>> _output_ports;
@@ -106,7 +106,8 @@ public:
             else
             	out_p->print();
         }
-        _coordinator.reset(new coordinator<TIME, MSG, nullqueue>{cm});
+        OBSERVER<TIME, MSG>::reset(); //events of previous runs are not counted
+        _coordinator.reset(new coordinator<TIME, MSG, nullqueue, OBSERVER>{cm});
         _driver.reset(new driver<TIME,MSG>{ip,op});
         _next = _coordinator->init(TIME(00,00,00,010)); //TIME::currentTime()
         _silent = false;
@@ -140,10 +141,8 @@ public:
                 		break;
                 	}
                 }
-                auto out = _coordinator->collectOutputs(_next);
+                auto out = _coordinator->step(_next); //collects outputs and advances in a single pass
                 if (!out.empty()) process_output(_next, out);
-
-                _coordinator->advanceSimulation( _next);
                 _next = _coordinator->next();
 
             }
@@ -174,10 +173,8 @@ public:
                 		break;
                 	}
                 }
-                auto out = _coordinator->collectOutputs(_next);
+                auto out = _coordinator->step(_next); //collects outputs and advances in a single pass
                 if (!out.empty()) process_output(_next, out);
-
-                _coordinator->advanceSimulation( _next);
                 _next = _coordinator->next();
 
             }
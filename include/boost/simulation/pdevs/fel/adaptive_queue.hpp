@@ -0,0 +1,245 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BOOST_SIMULATION_PDEVS_FEL_ADAPTIVE_QUEUE_H
+#define BOOST_SIMULATION_PDEVS_FEL_ADAPTIVE_QUEUE_H
+#include <vector>
+#include <cassert>
+#include <iterator>
+#include <utility>
+#include <algorithm>
+#include <boost/simulation/pdevs/fel/calendar_queue.hpp>
+
+namespace boost {
+namespace simulation {
+namespace pdevs {
+
+/**
+ * @brief The adaptive_queue class is a FEL choosing its structure from the size and activity it observes.
+ *
+ * Using coordinator<TIME, MSG, adaptive_queue> each coupled model gets its own adaptive_queue, so the
+ * scheduling strategy is chosen per coupled level. The structures available are:
+ * - linear: an unsorted vector, scanned to extract all the events at the lowest time at once.
+ *   It is the best for small coupled models and for those where most children are imminent at once.
+ * - heap: a binary heap, for medium sized coupled models with sparse activity.
+ * - calendar: a calendar_queue, for large coupled models with sparse activity.
+ * Every window of pops the queue compares the events popped per distinct time (batch) with its size,
+ * and switches to a different structure when the activity profile changed. Switching is O(n).
+ */
+template <class VALUE_TYPE, class COMPARE_TYPE>
+class adaptive_queue
+{
+public:
+    enum class strategy { linear, heap, calendar };
+
+    //thresholds used to select the strategy
+    static constexpr std::size_t linear_max_size = 32; //always linear below
+    static constexpr std::size_t calendar_min_size = 128; //calendar from here if activity is sparse
+    static constexpr std::size_t dense_batch_divisor = 4; //dense if batch >= size / divisor
+    static constexpr std::size_t min_window = 64;
+
+private:
+    COMPARE_TYPE _comp;
+    strategy _strategy = strategy::linear;
+    //linear: unsorted events and the events at the lowest time
+    std::vector<VALUE_TYPE> _items;
+    std::vector<VALUE_TYPE> _ready;
+    //heap: _items is used as heap
+    //calendar:
+    calendar_queue<VALUE_TYPE, COMPARE_TYPE> _calendar;
+    //activity observed in current window
+    std::size_t _window_pops = 0;
+    std::size_t _window_batches = 0;
+
+    bool same_time(const VALUE_TYPE& a, const VALUE_TYPE& b) const { return !_comp(a, b) && !_comp(b, a); }
+
+    //linear: moves the events at the lowest time to _ready
+    void extract_ready() {
+        if (_items.empty()) return;
+        auto top = std::max_element(_items.begin(), _items.end(), _comp);
+        VALUE_TYPE pivot = *top;
+        auto rest = std::partition(_items.begin(), _items.end(), [this, &pivot](const VALUE_TYPE& v){ return !same_time(v, pivot); });
+        std::move(rest, _items.end(), std::back_inserter(_ready));
+        _items.erase(rest, _items.end());
+    }
+
+    std::vector<VALUE_TYPE> extract_all() {
+        std::vector<VALUE_TYPE> all;
+        switch (_strategy){
+        case strategy::linear:
+            all.swap(_items);
+            std::move(_ready.begin(), _ready.end(), std::back_inserter(all));
+            _ready.clear();
+            break;
+        case strategy::heap:
+            all.swap(_items);
+            break;
+        case strategy::calendar:
+            all.reserve(_calendar.size());
+            while (!_calendar.empty()){
+                all.push_back(_calendar.top());
+                _calendar.pop();
+            }
+            break;
+        }
+        return all;
+    }
+
+    strategy recommended() const noexcept {
+        std::size_t n = size() + 1;
+        if (n <= linear_max_size) return strategy::linear;
+        std::size_t batch = _window_pops / std::max<std::size_t>(1, _window_batches);
+        if (batch * dense_batch_divisor >= n) return strategy::linear;
+        return (n >= calendar_min_size ? strategy::calendar : strategy::heap);
+    }
+
+    void observe_pop(bool new_batch) {
+        _window_pops++;
+        if (new_batch) _window_batches++;
+        if (_window_pops >= std::max(min_window, size())){
+            strategy s = recommended();
+            if (s != _strategy) switch_to(s);
+            _window_pops = 0;
+            _window_batches = 0;
+        }
+    }
+
+public:
+    using value_type=VALUE_TYPE;
+    using size_type=std::size_t;
+
+    adaptive_queue() : adaptive_queue(COMPARE_TYPE()) {}
+    explicit adaptive_queue(const COMPARE_TYPE& comp) : _comp(comp), _calendar(comp) {}
+
+    bool empty() const noexcept { return size() == 0; }
+    size_type size() const noexcept {
+        return (_strategy == strategy::calendar ? _calendar.size() : _items.size() + _ready.size());
+    }
+    strategy current_strategy() const noexcept { return _strategy; }
+
+    /**
+     * @brief switch_to moves all events to the structure of strategy s.
+     */
+    void switch_to(strategy s) {
+        std::vector<VALUE_TYPE> all = extract_all();
+        _strategy = s;
+        switch (_strategy){
+        case strategy::linear:
+            _items.swap(all);
+            extract_ready();
+            break;
+        case strategy::heap:
+            _items.swap(all);
+            std::make_heap(_items.begin(), _items.end(), _comp);
+            break;
+        case strategy::calendar:
+            for (auto& v : all) _calendar.push(std::move(v));
+            break;
+        }
+    }
+
+    /**
+     * @brief top returns the event with the lowest time.
+     */
+    const VALUE_TYPE& top() const noexcept {
+        assert(!empty());
+        switch (_strategy){
+        case strategy::linear: return _ready.back();
+        case strategy::heap: return _items.front();
+        default: return _calendar.top();
+        }
+    }
+
+    void push(const VALUE_TYPE& v) { emplace(v); }
+
+    template<class... Args>
+    void emplace(Args&&... args) {
+        switch (_strategy){
+        case strategy::linear: {
+            VALUE_TYPE v(std::forward<Args>(args)...);
+            if (_ready.empty() || same_time(v, _ready.back())){
+                _ready.push_back(std::move(v));
+            } else if (_comp(_ready.back(), v)){ //earlier than the ready ones
+                std::move(_ready.begin(), _ready.end(), std::back_inserter(_items));
+                _ready.clear();
+                _ready.push_back(std::move(v));
+            } else {
+                _items.push_back(std::move(v));
+            }
+            break;
+        }
+        case strategy::heap:
+            _items.emplace_back(std::forward<Args>(args)...);
+            std::push_heap(_items.begin(), _items.end(), _comp);
+            break;
+        case strategy::calendar:
+            _calendar.emplace(std::forward<Args>(args)...);
+            break;
+        }
+    }
+
+    void pop() {
+        assert(!empty());
+        bool new_batch = false; //no other event is left at the time of the popped one
+        switch (_strategy){
+        case strategy::linear:
+            _ready.pop_back();
+            if (_ready.empty()){
+                new_batch = true;
+                extract_ready();
+            }
+            break;
+        case strategy::heap:
+            //the second lowest event is a child of the root
+            new_batch = !((_items.size() > 1 && same_time(_items[0], _items[1]))
+                          || (_items.size() > 2 && same_time(_items[0], _items[2])));
+            std::pop_heap(_items.begin(), _items.end(), _comp);
+            _items.pop_back();
+            break;
+        case strategy::calendar:
+            new_batch = !_calendar.top_is_shared();
+            _calendar.pop();
+            break;
+        }
+        observe_pop(new_batch);
+    }
+};
+
+template <class VALUE_TYPE, class COMPARE_TYPE>
+constexpr std::size_t adaptive_queue<VALUE_TYPE, COMPARE_TYPE>::linear_max_size;
+template <class VALUE_TYPE, class COMPARE_TYPE>
+constexpr std::size_t adaptive_queue<VALUE_TYPE, COMPARE_TYPE>::calendar_min_size;
+template <class VALUE_TYPE, class COMPARE_TYPE>
+constexpr std::size_t adaptive_queue<VALUE_TYPE, COMPARE_TYPE>::dense_batch_divisor;
+template <class VALUE_TYPE, class COMPARE_TYPE>
+constexpr std::size_t adaptive_queue<VALUE_TYPE, COMPARE_TYPE>::min_window;
+
+}
+}
+}
+
+#endif // BOOST_SIMULATION_PDEVS_FEL_ADAPTIVE_QUEUE_H
@@ -0,0 +1,174 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BOOST_SIMULATION_PDEVS_FEL_CALENDAR_QUEUE_H
+#define BOOST_SIMULATION_PDEVS_FEL_CALENDAR_QUEUE_H
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <utility>
+#include <algorithm>
+#include <boost/simulation/pdevs/fel/time_ticks.hpp>
+
+namespace boost {
+namespace simulation {
+namespace pdevs {
+
+/**
+ * @brief The calendar_queue class is a calendar queue (R. Brown, 1988) to be used as FEL by coordinators.
+ *
+ * It has the interface of std::priority_queue for VALUE_TYPE pairs of <TIME, event>.
+ * Events are hashed by their tick (see time_ticks) into a circular array of buckets of fixed width,
+ * each bucket being a day of a year. The queue looks for the top in the current day and moves to the
+ * next days as they are consumed. The number of buckets follows the size of the queue and the width
+ * is estimated from the separation between the events each time the calendar is resized, so
+ * insertion and removal take O(1) on average. Buckets are kept sorted with the top at the back.
+ */
+template <class VALUE_TYPE, class COMPARE_TYPE>
+class calendar_queue
+{
+    using TIME=typename VALUE_TYPE::first_type;
+
+    std::vector<std::vector<VALUE_TYPE>> _buckets;
+    COMPARE_TYPE _comp;
+    std::uint64_t _width = 1; //ticks per bucket
+    std::size_t _size = 0;
+    std::size_t _current = 0; //bucket of the top
+    std::uint64_t _current_end = 0; //first tick after the current day
+
+    static std::uint64_t tick(const VALUE_TYPE& v) noexcept { return time_ticks<TIME>::get(v.first); }
+    std::size_t bucket_of(std::uint64_t t) const noexcept { return (t / _width) % _buckets.size(); }
+
+    void insert(VALUE_TYPE&& v) {
+        std::vector<VALUE_TYPE>& b = _buckets[bucket_of(tick(v))];
+        b.insert(std::upper_bound(b.begin(), b.end(), v, _comp), std::move(v));
+    }
+
+    //sets the current day to the day of tick t
+    void move_to(std::uint64_t t) noexcept {
+        _current = bucket_of(t);
+        std::uint64_t day_start = (t / _width) * _width;
+        _current_end = day_start + _width;
+        if (_current_end < day_start) _current_end = ~std::uint64_t(0); //the last day of times
+    }
+
+    //moves the current day forward until the top is found
+    void locate() noexcept {
+        if (_size == 0) return;
+        for (std::size_t i = 0; i < _buckets.size(); i++){
+            const std::vector<VALUE_TYPE>& b = _buckets[_current];
+            if (!b.empty() && tick(b.back()) < _current_end) return;
+            _current = (_current + 1) % _buckets.size();
+            _current_end += _width;
+        }
+        //a whole year is empty, jump directly to the earliest event
+        std::size_t earliest = _buckets.size();
+        for (std::size_t i = 0; i < _buckets.size(); i++){
+            if (!_buckets[i].empty() && (earliest == _buckets.size() || _comp(_buckets[earliest].back(), _buckets[i].back()))){
+                earliest = i;
+            }
+        }
+        move_to(tick(_buckets[earliest].back()));
+    }
+
+    //rebuilds the calendar with a number of buckets and a width fitting the current events
+    void resize(std::size_t buckets) {
+        std::vector<VALUE_TYPE> all;
+        all.reserve(_size);
+        for (auto& b : _buckets) for (auto& v : b) all.push_back(std::move(v));
+        _buckets.assign(buckets, std::vector<VALUE_TYPE>{});
+        if (!all.empty()){
+            //width is 3 times the average separation of the events, as suggested by Brown
+            std::uint64_t lo = tick(all.front()), hi = lo;
+            for (auto& v : all){
+                lo = std::min(lo, tick(v));
+                hi = std::max(hi, tick(v));
+            }
+            _width = std::max<std::uint64_t>(1, 3 * ((hi - lo) / all.size()));
+            for (auto& v : all) insert(std::move(v));
+            move_to(lo);
+            locate();
+        }
+    }
+
+public:
+    using value_type=VALUE_TYPE;
+    using size_type=std::size_t;
+
+    calendar_queue() : calendar_queue(COMPARE_TYPE()) {}
+    explicit calendar_queue(const COMPARE_TYPE& comp) : _buckets(2), _comp(comp) {}
+
+    bool empty() const noexcept { return _size == 0; }
+    size_type size() const noexcept { return _size; }
+
+    /**
+     * @brief top returns the event with the lowest time.
+     */
+    const VALUE_TYPE& top() const noexcept {
+        assert(_size != 0);
+        return _buckets[_current].back();
+    }
+
+    /**
+     * @brief top_is_shared returns true if other events are scheduled at the time of the top.
+     */
+    bool top_is_shared() const noexcept {
+        assert(_size != 0);
+        const std::vector<VALUE_TYPE>& b = _buckets[_current];
+        return b.size() > 1 && !_comp(b[b.size() - 2], b.back());
+    }
+
+    void push(const VALUE_TYPE& v) { emplace(v); }
+
+    template<class... Args>
+    void emplace(Args&&... args) {
+        VALUE_TYPE v(std::forward<Args>(args)...);
+        std::uint64_t t = tick(v);
+        bool earlier = (_size == 0 || _comp(top(), v));
+        insert(std::move(v));
+        _size++;
+        if (earlier) move_to(t);
+        if (_size > 2 * _buckets.size()) resize(2 * _buckets.size());
+    }
+
+    void pop() {
+        assert(_size != 0);
+        _buckets[_current].pop_back();
+        _size--;
+        if (_buckets.size() > 2 && _size < _buckets.size() / 2){
+            resize(_buckets.size() / 2);
+        } else {
+            locate();
+        }
+    }
+};
+
+}
+}
+}
+
+#endif // BOOST_SIMULATION_PDEVS_FEL_CALENDAR_QUEUE_H
@@ -0,0 +1,62 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BOOST_SIMULATION_PDEVS_FEL_TIME_TICKS_H
+#define BOOST_SIMULATION_PDEVS_FEL_TIME_TICKS_H
+#include <cstdint>
+#include <boost/simulation/fixed_time.hpp>
+
+namespace boost {
+namespace simulation {
+namespace pdevs {
+
+/**
+ * @brief time_ticks maps a time to an unsigned integer count of ticks for the event lists bucketing by time.
+ * The mapping has to be monotone, different times can share a tick (event lists compare them by time to break it).
+ * The default casts the time, specialize it for time representations not convertible to integers.
+ */
+template<class TIME>
+struct time_ticks
+{
+    static std::uint64_t get(const TIME& t) noexcept {
+        return (t < TIME(0)) ? 0 : static_cast<std::uint64_t>(t);
+    }
+};
+
+template<std::int64_t TICKS_PER_UNIT>
+struct time_ticks<fixed_time<TICKS_PER_UNIT>>
+{
+    static std::uint64_t get(const fixed_time<TICKS_PER_UNIT>& t) noexcept {
+        return (t.ticks() < 0) ? 0 : static_cast<std::uint64_t>(t.ticks());
+    }
+};
+
+}
+}
+}
+
+#endif // BOOST_SIMULATION_PDEVS_FEL_TIME_TICKS_H
@@ -0,0 +1,198 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BOOST_SIMULATION_PDEVS_FEL_TIMING_WHEEL_H
+#define BOOST_SIMULATION_PDEVS_FEL_TIMING_WHEEL_H
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <boost/simulation/pdevs/fel/time_ticks.hpp>
+
+namespace boost {
+namespace simulation {
+namespace pdevs {
+
+/**
+ * @brief The timing_wheel class is a hierarchical timing wheel to be used as FEL by coordinators.
+ *
+ * It has the interface of std::priority_queue for VALUE_TYPE pairs of <TIME, event>.
+ * Times are mapped to integer ticks using time_ticks<TIME>. Each level of the wheel has 256 slots,
+ * level 0 slots are a tick wide, and each upper level slot covers a whole lower level.
+ * Events are inserted in O(1) in the lowest level they share the upper ticks with the current tick,
+ * when the current slot is consumed the wheel advances to the next occupied slot and cascades the
+ * upper level slots as they are reached. Up to 8 levels are created on demand to cover 64 bits ticks.
+ * The slot of the current tick is sorted using COMPARE_TYPE when reached, so times mapped to the
+ * same tick are ordered the same way std::priority_queue does.
+ * As in any FEL, events can not be scheduled before the top event.
+ */
+template <class VALUE_TYPE, class COMPARE_TYPE>
+class timing_wheel
+{
+    using TIME=typename VALUE_TYPE::first_type;
+    static constexpr unsigned slot_bits = 8;
+    static constexpr unsigned slots = 1u << slot_bits;
+    static constexpr unsigned words = slots / 64;
+
+    struct level{
+        std::array<std::vector<VALUE_TYPE>, slots> slot;
+        std::array<std::uint64_t, words> occupied{}; //bitmap of non empty slots
+    };
+
+    std::vector<level> _levels; //created when first needed
+    COMPARE_TYPE _comp;
+    std::uint64_t _cursor = 0; //current tick, no event is scheduled before it
+    std::size_t _size = 0;
+
+    static unsigned lowest_bit(std::uint64_t w) noexcept {
+#if defined(__GNUC__)
+        return __builtin_ctzll(w);
+#else
+        unsigned b = 0;
+        while (!(w & 1)){ w >>= 1; b++; }
+        return b;
+#endif
+    }
+    static unsigned highest_bit(std::uint64_t w) noexcept {
+#if defined(__GNUC__)
+        return 63 - __builtin_clzll(w);
+#else
+        unsigned b = 0;
+        while (w >>= 1) b++;
+        return b;
+#endif
+    }
+    //first occupied slot starting at slot from, or slots if none
+    static unsigned next_occupied(const level& l, unsigned from) noexcept {
+        for (unsigned w = from / 64; w < words; w++){
+            std::uint64_t bits = l.occupied[w];
+            if (w == from / 64) bits &= (~std::uint64_t(0)) << (from % 64);
+            if (bits) return w * 64 + lowest_bit(bits);
+        }
+        return slots;
+    }
+    static unsigned slot_of(std::uint64_t tick, unsigned lvl) noexcept {
+        return static_cast<unsigned>((tick >> (lvl * slot_bits)) & (slots - 1));
+    }
+
+    void place(VALUE_TYPE&& v) {
+        std::uint64_t tick = time_ticks<TIME>::get(v.first);
+        if (tick < _cursor) tick = _cursor; //scheduling in the past is not allowed, keep it at the current tick
+        std::uint64_t diff = tick ^ _cursor;
+        unsigned lvl = (diff == 0 ? 0 : highest_bit(diff) / slot_bits);
+        if (_levels.size() <= lvl) _levels.resize(lvl + 1);
+        unsigned s = slot_of(tick, lvl);
+        _levels[lvl].slot[s].push_back(std::move(v));
+        _levels[lvl].occupied[s / 64] |= std::uint64_t(1) << (s % 64);
+    }
+
+    //moves the cursor to the first occupied tick, cascading upper levels as needed
+    void advance() {
+        while (true){
+            unsigned s = next_occupied(_levels[0], slot_of(_cursor, 0));
+            if (s != slots){
+                _cursor = (_cursor & ~std::uint64_t(slots - 1)) | s;
+                //the current slot is kept sorted with the top at the back
+                std::vector<VALUE_TYPE>& current = _levels[0].slot[s];
+                std::sort(current.begin(), current.end(), _comp);
+                return;
+            }
+            unsigned lvl = 1;
+            for (; lvl < _levels.size(); lvl++){
+                unsigned from = slot_of(_cursor, lvl) + 1;
+                s = (from < slots ? next_occupied(_levels[lvl], from) : slots);
+                if (s != slots) break;
+            }
+            assert(lvl < _levels.size() && "Non empty wheel has to have an occupied slot");
+            //move the cursor to the start of the slot found and cascade its events
+            unsigned shift = lvl * slot_bits;
+            std::uint64_t upper = (shift + slot_bits < 64) ? (_cursor >> (shift + slot_bits)) << (shift + slot_bits) : 0;
+            _cursor = upper | (std::uint64_t(s) << shift);
+            std::vector<VALUE_TYPE> cascading;
+            cascading.swap(_levels[lvl].slot[s]);
+            _levels[lvl].occupied[s / 64] &= ~(std::uint64_t(1) << (s % 64));
+            for (auto& v : cascading) place(std::move(v));
+        }
+    }
+
+public:
+    using value_type=VALUE_TYPE;
+    using size_type=std::size_t;
+
+    timing_wheel() : timing_wheel(COMPARE_TYPE()) {}
+    explicit timing_wheel(const COMPARE_TYPE& comp) : _comp(comp) {}
+
+    bool empty() const noexcept { return _size == 0; }
+    size_type size() const noexcept { return _size; }
+
+    /**
+     * @brief top returns the event with the lowest time.
+     */
+    const VALUE_TYPE& top() const noexcept {
+        assert(_size != 0);
+        return _levels[0].slot[slot_of(_cursor, 0)].back();
+    }
+
+    void push(const VALUE_TYPE& v) { emplace(v); }
+
+    template<class... Args>
+    void emplace(Args&&... args) {
+        VALUE_TYPE v(std::forward<Args>(args)...);
+        if (_size == 0){
+            if (_levels.empty()) _levels.resize(1);
+            _cursor = time_ticks<TIME>::get(v.first); //the wheel can be restarted anywhere when empty
+        }
+        _size++;
+        if (time_ticks<TIME>::get(v.first) <= _cursor){ //goes to the current slot, keep it sorted
+            unsigned s = slot_of(_cursor, 0);
+            std::vector<VALUE_TYPE>& current = _levels[0].slot[s];
+            current.insert(std::upper_bound(current.begin(), current.end(), v, _comp), std::move(v));
+            _levels[0].occupied[s / 64] |= std::uint64_t(1) << (s % 64);
+        } else {
+            place(std::move(v));
+        }
+    }
+
+    void pop() {
+        assert(_size != 0);
+        unsigned s = slot_of(_cursor, 0);
+        std::vector<VALUE_TYPE>& current = _levels[0].slot[s];
+        current.pop_back();
+        _size--;
+        if (current.empty()){
+            _levels[0].occupied[s / 64] &= ~(std::uint64_t(1) << (s % 64));
+            if (_size != 0) advance();
+        }
+    }
+};
+
+}
+}
+}
+
+#endif // BOOST_SIMULATION_PDEVS_FEL_TIMING_WHEEL_H
@@ -0,0 +1,173 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BOOST_SIMULATION_PDEVS_OBSERVERS_H
+#define BOOST_SIMULATION_PDEVS_OBSERVERS_H
+#include <iostream>
+#include <vector>
+#include <boost/simulation/pdevs/atomic.hpp>
+
+namespace boost {
+namespace simulation {
+namespace pdevs {
+
+/**
+ * @brief transition_kind tells observers which transition function was run by a simulator.
+ */
+enum class transition_kind { internal, external, confluence };
+
+/**
+ * @brief The null_observer class is the default observer policy of coordinators and runners.
+ * All hooks are empty, so they compile away and add no cost to the simulation.
+ *
+ * An observer policy is a template of TIME and MSG providing the static hooks:
+ * - transition: called after an atomic model runs a transition function at time t.
+ * - output: called after an atomic model computes its output bag at time t.
+ * - route: called when a bag of messages is copied from a model to a model at time t,
+ *   where the models can be atomic or coupled.
+ * - reset: clears what was observed, runners call it when they build a simulation.
+ *
+ * The hooks are called by the thread running the simulation. Observers keeping state keep it per thread,
+ * so simulations running concurrently in different threads do not mix their events.
+ */
+template<class TIME, class MSG>
+struct null_observer
+{
+    static void reset() noexcept {}
+    static void transition(transition_kind, atomic<TIME, MSG>&, const TIME&) noexcept {}
+    static void output(const atomic<TIME, MSG>&, const std::vector<MSG>&, const TIME&) noexcept {}
+    static void route(const model<TIME>&, const model<TIME>&, const std::vector<MSG>&, const TIME&) noexcept {}
+};
+
+/**
+ * @brief The counting_observer class counts the events of the coordinators using it in the current thread.
+ * Counters are shared by the simulations using the same TIME and MSG in a thread, runners reset them when
+ * they are constructed, reset them before running coordinators directly.
+ */
+template<class TIME, class MSG>
+struct counting_observer
+{
+    struct counters_type{
+        std::size_t internals = 0;
+        std::size_t externals = 0;
+        std::size_t confluences = 0;
+        std::size_t outputs = 0; //calls to out functions
+        std::size_t output_messages = 0;
+        std::size_t routes = 0; //bags copied between models
+        std::size_t routed_messages = 0;
+    };
+    static thread_local counters_type counters;
+
+    static void reset() noexcept { counters = counters_type{}; }
+
+    static void transition(transition_kind k, atomic<TIME, MSG>&, const TIME&) noexcept {
+        switch (k){
+        case transition_kind::internal: counters.internals++; break;
+        case transition_kind::external: counters.externals++; break;
+        case transition_kind::confluence: counters.confluences++; break;
+        }
+    }
+    static void output(const atomic<TIME, MSG>&, const std::vector<MSG>& mb, const TIME&) noexcept {
+        counters.outputs++;
+        counters.output_messages += mb.size();
+    }
+    static void route(const model<TIME>&, const model<TIME>&, const std::vector<MSG>& mb, const TIME&) noexcept {
+        counters.routes++;
+        counters.routed_messages += mb.size();
+    }
+};
+
+template<class TIME, class MSG>
+thread_local typename counting_observer<TIME, MSG>::counters_type counting_observer<TIME, MSG>::counters;
+
+/**
+ * @brief The logging_observer class writes a line per transition and output to a stream (std::clog by default).
+ * It also calls the print function of the atomic models on each transition, as simulators used to do.
+ * The stream is a setting shared by all threads, it keeps no state to reset.
+ */
+template<class TIME, class MSG>
+struct logging_observer
+{
+    static std::ostream* stream;
+
+    static void reset() noexcept {}
+
+    static void transition(transition_kind k, atomic<TIME, MSG>& m, const TIME& t) noexcept {
+        *stream << t << " " << m.asString()
+                << (k == transition_kind::internal ? " internal" : (k == transition_kind::external ? " external" : " confluence"))
+                << std::endl;
+        m.print();
+    }
+    static void output(const atomic<TIME, MSG>& m, const std::vector<MSG>& mb, const TIME& t) noexcept {
+        *stream << t << " " << m.asString() << " out " << mb.size() << " messages" << std::endl;
+    }
+    static void route(const model<TIME>&, const model<TIME>&, const std::vector<MSG>&, const TIME&) noexcept {}
+};
+
+template<class TIME, class MSG>
+std::ostream* logging_observer<TIME, MSG>::stream = &std::clog;
+
+/**
+ * @brief The tracing_observer class records every event in memory to be inspected after the simulation.
+ * Models are recorded by address, they are expected to outlive the trace.
+ * As counters of the counting_observer, the trace is kept per thread and cleared by runners when they are constructed.
+ */
+template<class TIME, class MSG>
+struct tracing_observer
+{
+    enum class event_kind { internal, external, confluence, output, route };
+    struct event{
+        event_kind kind;
+        TIME time;
+        const model<TIME>* from; //model transitioning, producing output or sending
+        const model<TIME>* to; //receiver of routes, nullptr otherwise
+        std::size_t messages;
+    };
+    static thread_local std::vector<event> trace;
+
+    static void reset() noexcept { trace.clear(); }
+
+    static void transition(transition_kind k, atomic<TIME, MSG>& m, const TIME& t) noexcept {
+        event_kind ek = (k == transition_kind::internal ? event_kind::internal : (k == transition_kind::external ? event_kind::external : event_kind::confluence));
+        trace.push_back(event{ek, t, &m, nullptr, 0});
+    }
+    static void output(const atomic<TIME, MSG>& m, const std::vector<MSG>& mb, const TIME& t) noexcept {
+        trace.push_back(event{event_kind::output, t, &m, nullptr, mb.size()});
+    }
+    static void route(const model<TIME>& from, const model<TIME>& to, const std::vector<MSG>& mb, const TIME& t) noexcept {
+        trace.push_back(event{event_kind::route, t, &from, &to, mb.size()});
+    }
+};
+
+template<class TIME, class MSG>
+thread_local std::vector<typename tracing_observer<TIME, MSG>::event> tracing_observer<TIME, MSG>::trace;
+
+}
+}
+}
+
+#endif // BOOST_SIMULATION_PDEVS_OBSERVERS_H
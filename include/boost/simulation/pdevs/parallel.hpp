@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BOOST_SIMULATION_PDEVS_PARALLEL_H
+#define BOOST_SIMULATION_PDEVS_PARALLEL_H
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <system_error>
+#include <algorithm>
+
+namespace boost {
+namespace simulation {
+namespace pdevs {
+
+/**
+ * @brief parallel_for runs f(i, nested_threads) for every i in [0, n) using up to threads threads.
+ * The calling thread takes part in the work. Indexes are taken in blocks from a shared counter,
+ * so unbalanced tasks like subtrees of different sizes keep all threads busy.
+ * The threads left when there are less tasks than threads are handed to the tasks as nested_threads,
+ * to be used by the task in its own parallel_for. With threads <= 1 it runs sequentially in order.
+ * If a task throws, no more tasks are started and the first exception is rethrown once all threads joined.
+ * If threads can not be started, the ones started do the work.
+ */
+template<class FUNC>
+void parallel_for(std::size_t n, unsigned threads, FUNC&& f){
+    if (threads <= 1 || n <= 1){
+        for (std::size_t i = 0; i < n; i++) f(i, threads);
+        return;
+    }
+    unsigned workers = static_cast<unsigned>(std::min<std::size_t>(threads, n));
+    unsigned nested = threads / workers;
+    std::size_t block = std::max<std::size_t>(1, n / (8 * workers));
+    std::atomic<std::size_t> next{0};
+    std::exception_ptr failure;
+    std::mutex failure_mutex;
+    auto work = [&](){
+        try {
+            for (std::size_t first = next.fetch_add(block); first < n; first = next.fetch_add(block)){
+                std::size_t last = std::min(n, first + block);
+                for (std::size_t i = first; i < last; i++) f(i, nested);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(failure_mutex);
+            if (!failure) failure = std::current_exception();
+            next.store(n); //the other threads take no more tasks
+        }
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    try {
+        for (unsigned w = 1; w < workers; w++) pool.emplace_back(work);
+    } catch (const std::system_error&) {} //run with the threads started
+    work();
+    for (auto& th : pool) th.join();
+    if (failure) std::rethrow_exception(failure);
+}
+
+}
+}
+}
+
+#endif // BOOST_SIMULATION_PDEVS_PARALLEL_H
@@ -0,0 +1,136 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BOOST_SIMULATION_PDEVS_PROTOTYPE_H
+#define BOOST_SIMULATION_PDEVS_PROTOTYPE_H
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <cassert>
+#include <boost/simulation/pdevs/coupled.hpp>
+#include <boost/simulation/pdevs/coordinator.hpp>
+
+namespace boost {
+namespace simulation {
+namespace pdevs {
+
+/**
+ * @brief The prototype class instantiates copies of a coupled model resolved once.
+ * The couplings of the prototype are flattened when it is constructed, each instance is a flattened_coupled
+ * with the same indexes and fresh copies of the atomic models, so no coupling is resolved again.
+ * The COORDINATOR of the prototype is also built once, coordinate copies it for an instance: its simulators and
+ * relays are created in the same storage order and its routes are rebased to them, nothing is collapsed again.
+ * The atomic models are copied using clone, they have to be created by make_atomic_ptr and be copyable.
+ * The copies are made by the copy constructor of each model, so members held by shared_ptr are shared among
+ * the instances and the prototype, like the parameters of the basic models or the input stream of an event_stream.
+ * The models of the prototype should not be simulated, their state is the initial state of every instance.
+ */
+template<class TIME, class MSG, class COORDINATOR=coordinator<TIME, MSG>>
+class prototype
+{
+    using flat_type=flattened_coupled<TIME, MSG>;
+    using models_type=std::vector<std::shared_ptr<model<TIME>>>;
+    using couplings_type=std::vector<std::pair<std::shared_ptr<model<TIME>>, std::shared_ptr<model<TIME>>>>;
+
+    std::shared_ptr<flat_type> _model;
+    std::vector<const atomic<TIME, MSG>*> _atomics; //models of the prototype, cast once
+    std::unique_ptr<COORDINATOR> _coordinator; //of the prototype, never run, copied by coordinate
+
+public:
+    /**
+     * @brief prototype flattens the coupled model if it is not flat already, checks its models can be copied
+     * and builds its coordinator.
+     * @param c is the coupled model copied by each instance.
+     * @param reorder tells the coordinator to store the simulators by locality, the copies keep its order.
+     * @throw std::invalid_argument if an atomic model can not be cloned.
+     */
+    explicit prototype(std::shared_ptr<coupled<TIME, MSG>> c, bool reorder=false)
+        : _model(std::dynamic_pointer_cast<flat_type>(c))
+    {
+        if (_model == nullptr) _model = std::make_shared<flat_type>(models_type{c}, models_type{c}, couplings_type{}, models_type{c});
+        const auto& flat = _model->get_flat_description();
+        _atomics.reserve(flat.models.size());
+        for (auto& m : flat.models){
+            const atomic<TIME, MSG>* a = dynamic_cast<const atomic<TIME, MSG>*>(m.get());
+            if (a == nullptr || a->dispatch().clone == nullptr){
+                throw std::invalid_argument("prototype: models need to be created by make_atomic_ptr and be copyable");
+            }
+            _atomics.push_back(a);
+        }
+        _coordinator.reset(new COORDINATOR(_model, 1, false, reorder));
+    }
+
+    /**
+     * @brief size is the number of atomic models in each instance.
+     */
+    std::size_t size() const noexcept {
+        return _atomics.size();
+    }
+
+    /**
+     * @brief instantiate creates a copy of the prototype, the couplings are copied as indexes.
+     */
+    std::shared_ptr<flat_type> instantiate() const {
+        const auto& flat = _model->get_flat_description();
+        typename flat_type::flat_description copy;
+        copy.models.reserve(_atomics.size());
+        for (const atomic<TIME, MSG>* m : _atomics){
+            std::shared_ptr<atomic<TIME, MSG>> c = m->clone();
+            assert(c != nullptr && "Models in prototypes need to be created by make_atomic_ptr and be copyable");
+            copy.models.push_back(std::move(c));
+        }
+        copy.external_input_coupling = flat.external_input_coupling;
+        copy.coupling_offsets = flat.coupling_offsets;
+        copy.coupling_targets = flat.coupling_targets;
+        copy.external_output_coupling = flat.external_output_coupling;
+        return std::make_shared<flat_type>(std::move(copy));
+    }
+
+    /**
+     * @brief instantiate creates n copies of the prototype.
+     */
+    std::vector<std::shared_ptr<flat_type>> instantiate(std::size_t n) const {
+        std::vector<std::shared_ptr<flat_type>> copies;
+        copies.reserve(n);
+        for (std::size_t i = 0; i < n; i++) copies.push_back(instantiate());
+        return copies;
+    }
+
+    /**
+     * @brief coordinate creates the coordinator of an instance by copying the coordinator of the prototype.
+     * @throw std::invalid_argument if the instance does not have the size of the prototype.
+     */
+    std::unique_ptr<COORDINATOR> coordinate(std::shared_ptr<flat_type> instance) const {
+        return std::unique_ptr<COORDINATOR>(new COORDINATOR(*_coordinator, std::move(instance)));
+    }
+};
+
+}
+}
+}
+
+#endif // BOOST_SIMULATION_PDEVS_PROTOTYPE_H
@@ -0,0 +1,97 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BOOST_SIMULATION_PDEVS_REORDER_H
+#define BOOST_SIMULATION_PDEVS_REORDER_H
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <algorithm>
+
+namespace boost {
+namespace simulation {
+namespace pdevs {
+
+/**
+ * @brief reverse_cuthill_mckee orders the n vertices of a graph so that neighbours are placed close to each other.
+ * Edges are pairs of vertices in [0, n) and their direction is ignored. Each connected component is walked
+ * breadth first from a vertex of minimum degree, visiting the neighbours of a vertex by increasing degree,
+ * and the resulting order is reversed.
+ * @return the vertex placed in each position, a permutation of [0, n).
+ */
+inline std::vector<std::uint32_t> reverse_cuthill_mckee(std::size_t n, const std::vector<std::pair<std::uint32_t, std::uint32_t>>& edges){
+    //undirected adjacency in compressed rows
+    std::vector<std::size_t> offsets(n + 1, 0);
+    for (auto& e : edges){
+        if (e.first == e.second) continue;
+        offsets[e.first + 1]++;
+        offsets[e.second + 1]++;
+    }
+    for (std::size_t v = 0; v < n; v++) offsets[v + 1] += offsets[v];
+    std::vector<std::uint32_t> adjacent(offsets[n]);
+    std::vector<std::size_t> filled(offsets.begin(), offsets.end() - 1);
+    for (auto& e : edges){
+        if (e.first == e.second) continue;
+        adjacent[filled[e.first]++] = e.second;
+        adjacent[filled[e.second]++] = e.first;
+    }
+    auto degree = [&offsets](std::uint32_t v){ return offsets[v + 1] - offsets[v]; };
+    auto by_degree = [&degree](std::uint32_t a, std::uint32_t b){ return degree(a) < degree(b); };
+    //components start from the unvisited vertex of minimum degree
+    std::vector<std::uint32_t> starts(n);
+    for (std::size_t v = 0; v < n; v++) starts[v] = static_cast<std::uint32_t>(v);
+    std::stable_sort(starts.begin(), starts.end(), by_degree);
+    std::vector<std::uint32_t> order;
+    order.reserve(n);
+    std::vector<bool> visited(n, false);
+    for (std::uint32_t s : starts){
+        if (visited[s]) continue;
+        visited[s] = true;
+        std::size_t head = order.size();
+        order.push_back(s);
+        for (; head < order.size(); head++){
+            std::uint32_t v = order[head];
+            std::size_t first = order.size();
+            for (std::size_t k = offsets[v]; k < offsets[v + 1]; k++){
+                std::uint32_t w = adjacent[k];
+                if (!visited[w]){
+                    visited[w] = true;
+                    order.push_back(w);
+                }
+            }
+            std::stable_sort(order.begin() + first, order.end(), by_degree);
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+}
+}
+}
+
+#endif // BOOST_SIMULATION_PDEVS_REORDER_H
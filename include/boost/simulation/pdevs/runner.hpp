@@ -42,11 +42,11 @@ namespace pdevs {
  * conditions, the ending conditions and the loggers, then it runs the simulation and
  * displays the results.
  */
-template <class TIME, class MSG, template<class, class> class FEL=nullqueue>
+template <class TIME, class MSG, template<class, class> class FEL=nullqueue, template<class, class> class OBSERVER=null_observer>
 class runner
 {
     TIME _next; //next scheduled event
-    std::shared_ptr<coordinator<TIME, MSG, nullqueue>> _coordinator; //ecoordinator of the top level coupled model.
+    std::shared_ptr<coordinator<TIME, MSG, FEL, OBSERVER>> _coordinator; //ecoordinator of the top level coupled model.
     bool _silent;
     std::ostream& _out_stream;
     void (*_out_interpreter)(std::ostream&, MSG);
@@ -71,14 +71,19 @@ public:
      * @param out_stream is where the model output goes for displaying.
      * @param out_interpreter a function to handle the insertion of
      *        model output messages into the out_stream.
+     * @param build_threads is the number of threads used to build and initialize
+     *        the coordinator tree, the subtrees of the top level are processed concurrently
+     *        if the model has at least coordinator::parallel_threshold atomic models.
      */
     explicit runner(std::shared_ptr<coupled<TIME, MSG>> cm,
                     const TIME& init_time, std::ostream& out_stream,
-                    decltype(_out_interpreter) out_interpreter) noexcept
+                    decltype(_out_interpreter) out_interpreter,
+                    unsigned build_threads=1)
         : _out_stream(out_stream), _out_interpreter(out_interpreter), infinity(cm->infinity)
     {
-        _coordinator.reset(new coordinator<TIME, MSG, nullqueue>{cm});
-        _next = _coordinator->init(init_time);
+        OBSERVER<TIME, MSG>::reset(); //events of previous runs are not counted
+        _coordinator.reset(new coordinator<TIME, MSG, FEL, OBSERVER>{cm, build_threads});
+        _next = _coordinator->init(init_time, build_threads);
         _silent = false;
     }
 
@@ -87,13 +92,17 @@ public:
      * @brief Runner constructing from a M model, its silent, no output.
      * @param cm is the coupled model in Extended DEVS to simulate.
      * @param init_time is the initial time of the simulation.
+     * @param build_threads is the number of threads used to build and initialize
+     *        the coordinator tree, as in the other constructor.
      */
-    explicit runner(std::shared_ptr<coupled<TIME, MSG>> cm, const TIME& init_time) noexcept
+    explicit runner(std::shared_ptr<coupled<TIME, MSG>> cm, const TIME& init_time,
+                    unsigned build_threads=1)
      : _out_stream( std::cerr ), //for debuging purposes
       infinity(cm->infinity)
     {
-        _coordinator.reset(new coordinator<TIME, MSG, nullqueue>{cm});
-        _next = _coordinator->init(init_time);
+        OBSERVER<TIME, MSG>::reset(); //events of previous runs are not counted
+        _coordinator.reset(new coordinator<TIME, MSG, FEL, OBSERVER>{cm, build_threads});
+        _next = _coordinator->init(init_time, build_threads);
         _silent = true;
     }
 
@@ -114,16 +123,43 @@ public:
         } else {
             while (_next < t)
             {
-                auto out = _coordinator->collectOutputs(_next);
+                auto out = _coordinator->step(_next); //collects outputs and advances in a single pass
                 if (!out.empty()) process_output(_next, out);
-
-                _coordinator->advanceSimulation( _next);
                 _next = _coordinator->next();
             }
         }
         return _next;
     }
 
+    /**
+     * @brief inject runs the simulation until t and introduces a bag of messages as external input at t.
+     * The messages go to the models coupled to the input of the top level model.
+     * @param bag is the external input.
+     * @param t is the time of the input.
+     * @return the TIME of the next event to happen after the input.
+     */
+    TIME inject(const std::vector<MSG>& bag, const TIME& t) noexcept
+    {
+        runUntil(t);
+        _coordinator->receive(bag, t);
+        if (_silent || _next != t){
+            _coordinator->advanceSimulation(t);
+        } else {
+            auto out = _coordinator->step(t);
+            if (!out.empty()) process_output(t, out);
+        }
+        _next = _coordinator->next();
+        return _next;
+    }
+
+    /**
+     * @brief next is the time of the next event to happen.
+     */
+    TIME next() const noexcept
+    {
+        return _next;
+    }
+
     /**
      * @brief runUntilPassivate starts the simulation and stops when there is no next internal event to happen.
      */
@@ -138,10 +174,8 @@ public:
         } else {
             while ( _next != infinity)
             {
-                auto out = _coordinator->collectOutputs(_next);
+                auto out = _coordinator->step(_next); //collects outputs and advances in a single pass
                 if (!out.empty()) process_output(_next, out);
-
-                _coordinator->advanceSimulation( _next);
                 _next = _coordinator->next();
             }
         }
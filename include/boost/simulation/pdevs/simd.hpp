@@ -0,0 +1,183 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BOOST_SIMULATION_PDEVS_SIMD_H
+#define BOOST_SIMULATION_PDEVS_SIMD_H
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <boost/simulation/fixed_time.hpp>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace boost {
+namespace simulation {
+namespace pdevs {
+
+/**
+ * The kernels used by the coordinators to scan the next times of their children, kept in contiguous arrays.
+ * min_time finds the earliest time and for_each_equal visits the positions of the children scheduled at a time.
+ * Time representations stored as doubles or 64 bits integers, like fixed_time, use vector instructions
+ * when the compiler targets them (AVX2, SSE2 for doubles and SSE4.2 for integers), any other runs the scalar loop.
+ */
+
+/**
+ * @brief min_time returns the minimum of the n times, or init if it is smaller.
+ */
+template<class TIME>
+TIME min_time(const TIME* times, std::size_t n, TIME init) noexcept {
+    for (std::size_t i = 0; i < n; i++){
+        if (times[i] < init) init = times[i];
+    }
+    return init;
+}
+
+/**
+ * @brief for_each_equal calls f(i) for every position i in [0, n) where times[i] == t, in order.
+ */
+template<class TIME, class FUNC>
+void for_each_equal(const TIME* times, std::size_t n, const TIME& t, FUNC&& f) noexcept {
+    for (std::size_t i = 0; i < n; i++){
+        if (times[i] == t) f(i);
+    }
+}
+
+namespace detail {
+
+//calls f for the bits set in mask, starting from position first
+template<class FUNC>
+void for_each_bit(unsigned mask, std::size_t first, FUNC& f) noexcept {
+    for (; mask != 0; mask &= mask - 1){
+        f(first + static_cast<std::size_t>(__builtin_ctz(mask)));
+    }
+}
+
+}
+
+#if defined(__AVX2__) || defined(__SSE2__)
+inline double min_time(const double* times, std::size_t n, double init) noexcept {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    __m256d acc = _mm256_set1_pd(init);
+    for (; i + 4 <= n; i += 4) acc = _mm256_min_pd(acc, _mm256_loadu_pd(times + i));
+    __m128d half = _mm_min_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+#else
+    __m128d half = _mm_set1_pd(init);
+    for (; i + 2 <= n; i += 2) half = _mm_min_pd(half, _mm_loadu_pd(times + i));
+#endif
+    half = _mm_min_sd(half, _mm_unpackhi_pd(half, half));
+    return min_time<double>(times + i, n - i, _mm_cvtsd_f64(half));
+}
+
+template<class FUNC>
+void for_each_equal(const double* times, std::size_t n, const double& t, FUNC&& f) noexcept {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    __m256d value = _mm256_set1_pd(t);
+    for (; i + 4 <= n; i += 4){
+        detail::for_each_bit(static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(times + i), value, _CMP_EQ_OQ))), i, f);
+    }
+#else
+    __m128d value = _mm_set1_pd(t);
+    for (; i + 2 <= n; i += 2){
+        detail::for_each_bit(static_cast<unsigned>(_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(times + i), value))), i, f);
+    }
+#endif
+    for (; i < n; i++){
+        if (times[i] == t) f(i);
+    }
+}
+#endif
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+inline std::int64_t min_time(const std::int64_t* times, std::size_t n, std::int64_t init) noexcept {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    __m256i acc = _mm256_set1_epi64x(init);
+    for (; i + 4 <= n; i += 4){
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(times + i));
+        acc = _mm256_blendv_epi8(acc, v, _mm256_cmpgt_epi64(acc, v));
+    }
+    __m128i half = _mm256_castsi256_si128(acc);
+    __m128i high = _mm256_extracti128_si256(acc, 1);
+#else
+    __m128i half = _mm_set1_epi64x(init);
+    for (; i + 2 <= n; i += 2){
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(times + i));
+        half = _mm_blendv_epi8(half, v, _mm_cmpgt_epi64(half, v));
+    }
+    __m128i high = half;
+#endif
+    half = _mm_blendv_epi8(half, high, _mm_cmpgt_epi64(half, high));
+    high = _mm_unpackhi_epi64(half, half);
+    half = _mm_blendv_epi8(half, high, _mm_cmpgt_epi64(half, high));
+    return min_time<std::int64_t>(times + i, n - i, _mm_cvtsi128_si64(half));
+}
+
+template<class FUNC>
+void for_each_equal(const std::int64_t* times, std::size_t n, const std::int64_t& t, FUNC&& f) noexcept {
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    __m256i value = _mm256_set1_epi64x(t);
+    for (; i + 4 <= n; i += 4){
+        __m256i eq = _mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(times + i)), value);
+        detail::for_each_bit(static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(eq))), i, f);
+    }
+#else
+    __m128i value = _mm_set1_epi64x(t);
+    for (; i + 2 <= n; i += 2){
+        __m128i eq = _mm_cmpeq_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(times + i)), value);
+        detail::for_each_bit(static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(eq))), i, f);
+    }
+#endif
+    for (; i < n; i++){
+        if (times[i] == t) f(i);
+    }
+}
+
+//fixed_time is compared by its count of ticks, an array of them is scanned as an array of 64 bits integers
+template<std::int64_t TICKS_PER_UNIT>
+fixed_time<TICKS_PER_UNIT> min_time(const fixed_time<TICKS_PER_UNIT>* times, std::size_t n, fixed_time<TICKS_PER_UNIT> init) noexcept {
+    static_assert(sizeof(fixed_time<TICKS_PER_UNIT>) == sizeof(std::int64_t) && std::is_standard_layout<fixed_time<TICKS_PER_UNIT>>::value,
+                  "fixed_time is expected to be only its count of ticks");
+    return fixed_time<TICKS_PER_UNIT>::from_ticks(min_time(reinterpret_cast<const std::int64_t*>(times), n, init.ticks()));
+}
+
+template<std::int64_t TICKS_PER_UNIT, class FUNC>
+void for_each_equal(const fixed_time<TICKS_PER_UNIT>* times, std::size_t n, const fixed_time<TICKS_PER_UNIT>& t, FUNC&& f) noexcept {
+    static_assert(sizeof(fixed_time<TICKS_PER_UNIT>) == sizeof(std::int64_t) && std::is_standard_layout<fixed_time<TICKS_PER_UNIT>>::value,
+                  "fixed_time is expected to be only its count of ticks");
+    for_each_equal(reinterpret_cast<const std::int64_t*>(times), n, t.ticks(), f);
+}
+#endif
+
+}
+}
+}
+
+#endif // BOOST_SIMULATION_PDEVS_SIMD_H
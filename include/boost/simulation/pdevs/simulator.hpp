@@ -0,0 +1,189 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BOOST_SIMULATION_PDEVS_SIMULATOR_H
+#define BOOST_SIMULATION_PDEVS_SIMULATOR_H
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <boost/simulation/pdevs/atomic.hpp>
+#include <boost/simulation/pdevs/observers.hpp>
+
+namespace boost {
+namespace simulation {
+namespace pdevs {
+
+template<class TIME, class MSG, class COORDINATOR, template<class, class> class OBSERVER>
+class coordinator_base;
+
+/**
+ * @brief The node class has what simulators and coordinators share as members of the hierarchy:
+ * the schedule, the position in the parent, the inbox and the routes of the collapsed couplings.
+ * COORDINATOR is the type of the coordinators, the parents of all nodes.
+ */
+template<class TIME, class MSG, class COORDINATOR>
+class node
+{
+    friend COORDINATOR;
+    template<class, class, class, template<class, class> class> friend class coordinator_base;
+protected:
+    TIME _last; //last transition time
+    TIME _next; //next transition scheduled
+    COORDINATOR* _parent = nullptr; //coordinator of the upper level, null in the top level
+    std::vector<node*> _routes; //nodes receiving the outputs of this node, simulators, stubs or relays
+    std::vector<MSG> _inbox; //input consumed in the next transition
+    std::uint32_t _index = 0; //position in the children of the parent
+    bool _leaf; //is a simulator
+    bool _relay = false; //forwards what it receives to its routes, never transitions
+    bool _pending = false; //received input to be processed at current time
+    bool _imminent = false; //is in the imminents of the parent
+    bool _to_out = false; //outputs of this node are outputs of the top level
+
+    explicit node(bool leaf) noexcept : _leaf(leaf) {}
+
+public:
+    /**
+     * @brief next is the time of the next transition scheduled.
+     */
+    TIME next() const noexcept {
+        return _next;
+    }
+
+    /**
+     * @brief receive adds a bag to the inbox of this node and schedules its ancestors to advance at t.
+     * Imminent coordinators need no scheduling, they and their ancestors advance at t anyway.
+     */
+    void receive(const std::vector<MSG>& bag, const TIME& t) noexcept {
+        _inbox.insert(_inbox.end(), bag.begin(), bag.end());
+        for (node* n = this; n->_parent != nullptr && n->_next != t && !n->_pending; n = n->_parent){
+            n->_pending = true;
+            n->_parent->_receivers.push_back(n->_index);
+        }
+    }
+};
+
+/**
+ * @brief The relay class stands for the input of a coupled submodel reached from many nodes.
+ * The nodes send to the relay, which forwards to its routes, so coupling m senders to n receivers
+ * takes m + n routes in place of m * n. Relays only forward to simulators and stubs.
+ */
+template<class TIME, class MSG, class COORDINATOR>
+class relay : public node<TIME, MSG, COORDINATOR>
+{
+public:
+    relay() noexcept : node<TIME, MSG, COORDINATOR>(false) {
+        this->_relay = true;
+    }
+};
+
+/**
+ * @brief The simulator class runs a PDEVS atomic model, it is the leaf of the hierarchy of coordinators.
+ * It only keeps what a leaf uses: the model, its dispatch table and the output of the current transition.
+ * Simulators are stored by value in the coordinator of their level, the model is owned by the coupled model.
+ */
+template<class TIME, class MSG, class COORDINATOR, template<class, class> class OBSERVER>
+class simulator : public node<TIME, MSG, COORDINATOR>
+{
+    friend COORDINATOR;
+    atomic<TIME, MSG>* _model; // atomic model simulated
+    const atomic_dispatch<TIME, MSG>* _dispatch; // functions running the atomic model, not virtual if type is known
+    std::vector<MSG> _out; //output at _next
+    bool _out_ready = false; //_out was computed since last transition
+
+public:
+    explicit simulator(atomic<TIME, MSG>* m) noexcept
+        : node<TIME, MSG, COORDINATOR>(true), _model(m), _dispatch(&m->dispatch()) {}
+    simulator(simulator&&) = default; //stored in vectors, only moved before the routes point to it
+    simulator(const simulator&) = delete;
+    simulator& operator=(const simulator&) = delete;
+
+    /**
+     * @brief init sets the start time and schedules the first internal transition.
+     */
+    void init(const TIME& t) noexcept {
+        _out_ready = false;
+        this->_last = t;
+        this->_next = t + _model->advance();
+    }
+
+    /**
+     * @brief outputs computes the output bag at _next only once per transition.
+     */
+    const std::vector<MSG>& outputs() noexcept {
+        if (!_out_ready){
+            _out = _dispatch->out(*_model);
+            OBSERVER<TIME, MSG>::output(*_model, _out, this->_next);
+            _out_ready = true;
+        }
+        return _out;
+    }
+
+    /**
+     * @brief transition runs the transition at t with the bag collected in the inbox.
+     */
+    void transition(const TIME& t) noexcept {
+        _out_ready = false;
+        this->_pending = false;
+        assert(t >= this->_last);
+        assert(t <= this->_next);
+        if (this->_inbox.empty()){
+            if (t == this->_next){
+                this->_last = t;
+                this->_next = this->_last + _dispatch->internal(*_model);
+                OBSERVER<TIME, MSG>::transition(transition_kind::internal, *_model, t);
+            } else {
+                this->_last = t;
+            }
+        } else {
+            if (t == this->_next){ //confluence
+                TIME e = t - this->_last;
+                this->_last = t;
+                this->_next = this->_last + _dispatch->confluence(*_model, this->_inbox, e);
+                OBSERVER<TIME, MSG>::transition(transition_kind::confluence, *_model, t);
+            } else { //external
+                TIME e = t - this->_last;
+                this->_last = t;
+                this->_next = this->_last + _dispatch->external(*_model, this->_inbox, e);
+                OBSERVER<TIME, MSG>::transition(transition_kind::external, *_model, t);
+            }
+            this->_inbox.clear();
+        }
+    }
+
+    /**
+     * @brief coordinated returns the model simulated, to be reported to observers.
+     */
+    const model<TIME>& coordinated() const noexcept {
+        return *_model;
+    }
+};
+
+}
+}
+}
+
+#endif // BOOST_SIMULATION_PDEVS_SIMULATOR_H
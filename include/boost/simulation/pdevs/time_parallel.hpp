@@ -0,0 +1,259 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef BOOST_SIMULATION_PDEVS_TIME_PARALLEL_H
+#define BOOST_SIMULATION_PDEVS_TIME_PARALLEL_H
+#include <vector>
+#include <memory>
+#include <utility>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <cassert>
+#include <boost/simulation/pdevs/coordinator.hpp>
+#include <boost/simulation/pdevs/parallel.hpp>
+
+namespace boost {
+namespace simulation {
+namespace pdevs {
+
+/**
+ * @brief The time_parallel class runs a simulation splitting the time horizon in segments simulated concurrently.
+ *
+ * It suits models driven by long traces, like event_stream, that return often to a known state, like all queues
+ * empty. The model of each segment is built by a function receiving the start time of the segment, the model is in
+ * the state guessed for that time and its traces are read from that time on. The first segment starts from the real
+ * initial state. When all the segments are simulated, the state at the end of each segment is compared with the
+ * state guessed for the next one using atomic::equal_state. Where they differ, the simulation of the previous segment
+ * goes on through the next one, replacing its results. The segments fixed in the same pass run concurrently, and
+ * each pass fixes at least one more segment, so the results are the ones of a sequential run.
+ *
+ * The atomic models are copied at the boundaries to compare them, they have to be created by make_atomic_ptr and
+ * be copyable. The comparison is only as good as the equal_state of the models, which should be true only if the
+ * models behave the same from the boundary on.
+ *
+ * Observers are called by the threads simulating the segments, segments re-run are observed again, and the
+ * state of observers keeping it per thread, like the counting_observer, stays in those threads.
+ */
+template <class TIME, class MSG, template<class, class> class FEL=nullqueue, template<class, class> class OBSERVER=null_observer>
+class time_parallel
+{
+    using coordinator_type=coordinator<TIME, MSG, FEL, OBSERVER>;
+    using flat_type=flattened_coupled<TIME, MSG>;
+    using models_type=std::vector<std::shared_ptr<model<TIME>>>;
+    using couplings_type=std::vector<std::pair<std::shared_ptr<model<TIME>>, std::shared_ptr<model<TIME>>>>;
+
+    /**
+     * @brief The simulation struct is a running simulation, moved to the next segment when it goes on through it.
+     */
+    struct simulation{
+        std::shared_ptr<flat_type> model;
+        std::unique_ptr<coordinator_type> coordinator;
+        TIME next;
+    };
+    /**
+     * @brief The snapshot struct is the state of a simulation at a boundary: copies of its atomic models and its next time.
+     */
+    struct snapshot{
+        std::vector<std::shared_ptr<atomic<TIME, MSG>>> models;
+        TIME next;
+    };
+    struct segment{
+        simulation sim; //simulation at the end of the segment, empty if it went on through the next
+        snapshot start; //state the segment started from
+        snapshot end; //state at the end of the segment
+        std::vector<std::pair<TIME, std::vector<MSG>>> outputs;
+        bool continued = false; //started from the end of the last simulation of the previous segment
+    };
+
+    std::function<std::shared_ptr<coupled<TIME, MSG>>(const TIME&)> _guess;
+    std::vector<TIME> _boundaries; //start of each segment followed by the end of the last one
+    std::vector<segment> _segments;
+    unsigned _threads;
+    std::size_t _passes = 0;
+    std::size_t _reruns = 0;
+    bool _silent;
+    std::ostream& _out_stream;
+    void (*_out_interpreter)(std::ostream&, MSG);
+
+    /**
+     * @brief take copies the models of a simulation, the first copy of each segment is taken by start.
+     * @throw std::invalid_argument if a model can not be cloned.
+     */
+    static snapshot take(const simulation& sim){
+        snapshot s;
+        const auto& flat = sim.model->get_flat_description();
+        s.models.reserve(flat.models.size());
+        for (auto& m : flat.models){
+            std::shared_ptr<atomic<TIME, MSG>> c = static_cast<const atomic<TIME, MSG>&>(*m).clone();
+            if (c == nullptr) throw std::invalid_argument("time_parallel: models need to be created by make_atomic_ptr and be copyable");
+            s.models.push_back(std::move(c));
+        }
+        s.next = sim.next;
+        return s;
+    }
+
+    static bool same(const snapshot& a, const snapshot& b) noexcept {
+        if (a.next != b.next || a.models.size() != b.models.size()) return false;
+        for (std::size_t i = 0; i < a.models.size(); i++){
+            if (!a.models[i]->equal_state(*b.models[i])) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief start builds the simulation of segment i from the state guessed for its start.
+     * The models are checked by copying them before anything is simulated.
+     */
+    void start(std::size_t i){
+        segment& s = _segments[i];
+        std::shared_ptr<coupled<TIME, MSG>> c = _guess(_boundaries[i]);
+        s.sim.model = std::dynamic_pointer_cast<flat_type>(c);
+        if (s.sim.model == nullptr) s.sim.model = std::make_shared<flat_type>(models_type{c}, models_type{c}, couplings_type{}, models_type{c});
+        s.sim.coordinator.reset(new coordinator_type{s.sim.model});
+        s.sim.next = s.sim.coordinator->init(_boundaries[i]);
+        s.start = take(s.sim);
+    }
+
+    /**
+     * @brief simulate runs the simulation of segment i until its end.
+     */
+    void simulate(std::size_t i){
+        segment& s = _segments[i];
+        const TIME& end = _boundaries[i + 1];
+        s.outputs.clear();
+        if (_silent){
+            while (s.sim.next < end){
+                s.sim.coordinator->advanceSimulation(s.sim.next);
+                s.sim.next = s.sim.coordinator->next();
+            }
+        } else {
+            while (s.sim.next < end){
+                auto out = s.sim.coordinator->step(s.sim.next); //collects outputs and advances in a single pass
+                if (!out.empty()) s.outputs.emplace_back(s.sim.next, std::move(out));
+                s.sim.next = s.sim.coordinator->next();
+            }
+        }
+        s.end = take(s.sim);
+    }
+
+public:
+    /**
+     * @brief time_parallel constructor, the simulation of the segments starts when run is called.
+     * @param guess builds the model in the state guessed for a start time, reading its traces from that time.
+     * @param boundaries are the start of each segment followed by the end of the last one, in increasing order.
+     * @param out_stream is where the model output goes for displaying, in time order.
+     * @param out_interpreter a function to handle the insertion of model output messages into the out_stream.
+     * @param threads is the number of threads simulating segments.
+     */
+    time_parallel(std::function<std::shared_ptr<coupled<TIME, MSG>>(const TIME&)> guess, std::vector<TIME> boundaries,
+                  std::ostream& out_stream, decltype(_out_interpreter) out_interpreter, unsigned threads=1) noexcept
+        : _guess(std::move(guess)), _boundaries(std::move(boundaries)), _threads(threads),
+          _silent(false), _out_stream(out_stream), _out_interpreter(out_interpreter)
+    {
+        assert(_boundaries.size() >= 2 && "At least one segment is required");
+    }
+
+    /**
+     * @brief time_parallel constructor for silent simulations, with no output.
+     */
+    time_parallel(std::function<std::shared_ptr<coupled<TIME, MSG>>(const TIME&)> guess, std::vector<TIME> boundaries,
+                  unsigned threads=1) noexcept
+        : _guess(std::move(guess)), _boundaries(std::move(boundaries)), _threads(threads),
+          _silent(true), _out_stream(std::cerr), _out_interpreter(nullptr)
+    {
+        assert(_boundaries.size() >= 2 && "At least one segment is required");
+    }
+
+    /**
+     * @brief run simulates all the segments and fixes the ones whose guessed start differs from the end of the previous.
+     * @return the TIME of the next event after the end of the last segment.
+     * @throw std::invalid_argument if the models built by guess can not be cloned.
+     */
+    TIME run(){
+        std::size_t n = _boundaries.size() - 1;
+        _segments.clear();
+        _segments.resize(n);
+        _passes = 1;
+        _reruns = 0;
+        parallel_for(n, _threads, [this](std::size_t i, unsigned){
+            start(i);
+            simulate(i);
+        });
+        for (;;){
+            std::vector<std::size_t> wrong; //segments started from a state differing from the end of the previous
+            for (std::size_t i = 1; i < n; i++){
+                if (!_segments[i].continued && !same(_segments[i - 1].end, _segments[i].start)) wrong.push_back(i);
+            }
+            if (wrong.empty()) break;
+            //each wrong segment takes the simulation of the previous, taken before any of them is re-run
+            std::vector<simulation> taken(wrong.size());
+            for (std::size_t w = 0; w < wrong.size(); w++){
+                assert(_segments[wrong[w] - 1].sim.coordinator != nullptr && "Only re-run segments can change their end");
+                taken[w] = std::move(_segments[wrong[w] - 1].sim);
+            }
+            for (std::size_t w = 0; w < wrong.size(); w++){
+                segment& s = _segments[wrong[w]];
+                s.sim = std::move(taken[w]);
+                s.start = _segments[wrong[w] - 1].end;
+            }
+            parallel_for(wrong.size(), _threads, [this, &wrong](std::size_t w, unsigned){ simulate(wrong[w]); });
+            //the segments after the ones re-run have to be checked again against their new end
+            for (std::size_t i : wrong) _segments[i].continued = true;
+            for (std::size_t i : wrong) if (i + 1 < n) _segments[i + 1].continued = false;
+            _passes++;
+            _reruns += wrong.size();
+        }
+        if (!_silent){
+            for (auto& s : _segments){
+                for (auto& o : s.outputs){
+                    for (auto& msg : o.second){
+                        _out_stream << o.first << " ";
+                        _out_interpreter(_out_stream, msg);
+                        _out_stream << std::endl;
+                    }
+                }
+            }
+        }
+        return _segments.back().sim.next;
+    }
+
+    /**
+     * @brief passes is the number of times the segments were simulated in the last run, 1 if all the guesses were right.
+     */
+    std::size_t passes() const noexcept { return _passes; }
+    /**
+     * @brief reruns is the number of segments simulated again in the last run.
+     */
+    std::size_t reruns() const noexcept { return _reruns; }
+};
+
+}
+}
+}
+
+#endif // BOOST_SIMULATION_PDEVS_TIME_PARALLEL_H
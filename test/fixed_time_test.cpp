@@ -0,0 +1,185 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+#include <cmath>
+#include <boost/any.hpp>
+#include <boost/simulation/fixed_time.hpp>
+#include <boost/simulation/pdevs/coordinator.hpp>
+#include <boost/simulation/pdevs/basic_models/generator.hpp>
+#include <boost/simulation/pdevs/basic_models/processor.hpp>
+#include <boost/simulation/convenience.hpp>
+
+using namespace boost::simulation;
+using namespace boost::simulation::pdevs;
+using namespace boost::simulation::pdevs::basic_models;
+using namespace std;
+
+using Time=fixed_time<1000>;
+using Message=boost::any;
+
+BOOST_AUTO_TEST_SUITE( fixed_time_test_suite )
+
+BOOST_AUTO_TEST_CASE( fixed_time_resolution_test )
+{
+    BOOST_CHECK_EQUAL( Time{0}.ticks(), 0);
+    BOOST_CHECK_EQUAL( Time{3}.ticks(), 3000);
+    BOOST_CHECK_EQUAL( Time{1.5}.ticks(), 1500);
+    BOOST_CHECK_EQUAL( Time{0.0004}.ticks(), 0); //below resolution
+    BOOST_CHECK_EQUAL( Time{0.0006}.ticks(), 1);
+    BOOST_CHECK( Time{0.1} + Time{0.2} == Time{0.3}); //exact, unlike double
+    BOOST_CHECK( Time{2} - Time{0.5} == Time{1.5});
+}
+
+BOOST_AUTO_TEST_CASE( fixed_time_infinity_test )
+{
+    static_assert(Time::Inf().is_inf(), "Infinity has to be a compile-time constant");
+    BOOST_CHECK( Time{1} < Time::Inf());
+    BOOST_CHECK( (Time::Inf() + Time{1}).is_inf());
+    BOOST_CHECK( (Time{1} + Time::Inf()).is_inf());
+    BOOST_CHECK( (Time::Inf() - Time{1}).is_inf());
+}
+
+BOOST_AUTO_TEST_CASE( fixed_time_overflow_saturates_test )
+{
+    Time big = Time::from_ticks(numeric_limits<int64_t>::max() - 10);
+    BOOST_CHECK( !big.is_inf());
+    BOOST_CHECK( (big + Time{1}).is_inf());
+    BOOST_CHECK( Time{numeric_limits<int64_t>::max()}.is_inf());
+}
+
+BOOST_AUTO_TEST_CASE( fixed_time_underflow_saturates_test )
+{
+    Time small = Time::from_ticks(-numeric_limits<int64_t>::max() + 10);
+    BOOST_CHECK( small > -Time::Inf());
+    BOOST_CHECK( small - Time{1} == -Time::Inf());
+    BOOST_CHECK( small + Time{-1} == -Time::Inf());
+    BOOST_CHECK( Time{numeric_limits<int64_t>::min()} == -Time::Inf());
+    BOOST_CHECK( Time{1} - Time::Inf() == -Time::Inf());
+    BOOST_CHECK( (-Time::Inf() + Time{1}) == -Time::Inf());
+    BOOST_CHECK( (Time::Inf() - Time::Inf()).is_inf()); //infinity wins, as for passive models
+}
+
+BOOST_AUTO_TEST_CASE( fixed_time_negation_test )
+{
+    static_assert((-(-Time::Inf())).is_inf(), "Negating twice has to give back infinity");
+    BOOST_CHECK( -Time::Inf() < Time::from_ticks(-numeric_limits<int64_t>::max() + 1));
+    BOOST_CHECK( !(-Time::Inf()).is_inf());
+    BOOST_CHECK( -Time{1.5} == Time{-1.5});
+    BOOST_CHECK_EQUAL( (-Time::Inf()).to_double(), -numeric_limits<double>::infinity());
+}
+
+BOOST_AUTO_TEST_CASE( fixed_time_floating_point_out_of_range_test )
+{
+    BOOST_CHECK( Time{1e300}.is_inf());
+    BOOST_CHECK( Time{-1e300} == -Time::Inf());
+    BOOST_CHECK( Time{numeric_limits<double>::infinity()}.is_inf());
+    BOOST_CHECK( Time{-numeric_limits<double>::infinity()} == -Time::Inf());
+    BOOST_CHECK( Time{numeric_limits<double>::quiet_NaN()}.is_inf());
+    //2^63 ticks is above the range, the largest double below it is not
+    using Ticks=fixed_time<1>;
+    const double above = std::ldexp(1.0, 63);
+    const double below = std::nextafter(above, 0.0);
+    BOOST_CHECK( Ticks{above}.is_inf());
+    BOOST_CHECK( !Ticks{below}.is_inf());
+    BOOST_CHECK_EQUAL( Ticks{below}.ticks(), static_cast<int64_t>(below));
+    BOOST_CHECK( Ticks{-above} == -Ticks::Inf());
+    BOOST_CHECK_EQUAL( Ticks{-below}.ticks(), -static_cast<int64_t>(below));
+}
+
+BOOST_AUTO_TEST_CASE( fixed_time_from_ticks_clamps_test )
+{
+    BOOST_CHECK( Time::from_ticks(numeric_limits<int64_t>::min()) == -Time::Inf());
+    BOOST_CHECK_EQUAL( (Time::from_ticks(numeric_limits<int64_t>::min())).to_double(), -numeric_limits<double>::infinity());
+    BOOST_CHECK( -Time::from_ticks(numeric_limits<int64_t>::min()) == Time::Inf());
+    BOOST_CHECK( Time::from_ticks(numeric_limits<int64_t>::max()).is_inf());
+}
+
+BOOST_AUTO_TEST_CASE( fixed_time_streams_test )
+{
+    ostringstream oss;
+    oss << Time{1.5} << " " << Time{7} << " " << Time{-0.25} << " " << Time::Inf();
+    BOOST_CHECK_EQUAL( oss.str(), "1.5 7 -0.25 inf");
+
+    istringstream iss{"1.5 7 -0.25 inf 0.0015"};
+    Time t;
+    iss >> t;
+    BOOST_CHECK( t == Time{1.5});
+    iss >> t;
+    BOOST_CHECK( t == Time{7});
+    iss >> t;
+    BOOST_CHECK( t == Time{-0.25});
+    iss >> t;
+    BOOST_CHECK( t.is_inf());
+    iss >> t;
+    BOOST_CHECK_EQUAL( t.ticks(), 2); //rounded to nearest tick
+}
+
+BOOST_AUTO_TEST_CASE( fixed_time_streams_infinities_test )
+{
+    ostringstream oss;
+    oss << -Time::Inf();
+    BOOST_CHECK_EQUAL( oss.str(), "-inf");
+
+    istringstream iss{"-inf +inf 99999999999999999999999 -99999999999999999999999"};
+    Time t;
+    iss >> t;
+    BOOST_CHECK( t == -Time::Inf());
+    iss >> t;
+    BOOST_CHECK( t.is_inf());
+    iss >> t;
+    BOOST_CHECK( t.is_inf()); //too many digits saturate
+    iss >> t;
+    BOOST_CHECK( t == -Time::Inf());
+    BOOST_CHECK( !iss.fail());
+}
+
+BOOST_AUTO_TEST_CASE( fixed_time_coordinated_models_test )
+{
+    //create a generator sending jobs to a processor, connect the processor output.
+    //check the jobs are processed at the exact times.
+    auto pg = make_atomic_ptr<generator<Time, Message>, Time, Message>(Time{0.1}, Message{1});
+    auto pp = make_atomic_ptr<processor<Time, Message>, Time>(Time{0.05});
+    auto cm = std::shared_ptr<coupled<Time, Message>>(new coupled<Time, Message>{{pg, pp}, {}, {{pg, pp}}, {pp}});
+    coordinator<Time, Message> c{cm};
+
+    Time t = c.init(Time{0});
+    for (int i = 1; i <= 10; i++){
+        BOOST_CHECK( t == Time{0.1} + Time::from_ticks(100 * (i - 1))); //generator tick
+        auto reply = c.step(t);
+        BOOST_CHECK_EQUAL( reply.size(), 0);
+        t = c.next();
+        BOOST_CHECK( t == Time{0.15} + Time::from_ticks(100 * (i - 1))); //processor done
+        reply = c.step(t);
+        BOOST_CHECK_EQUAL( reply.size(), 1);
+        t = c.next();
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
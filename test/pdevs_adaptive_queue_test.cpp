@@ -0,0 +1,153 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <queue>
+#include <random>
+#include <boost/simulation/fixed_time.hpp>
+#include <boost/simulation/pdevs/coordinator.hpp>
+#include <boost/simulation/pdevs/fel/calendar_queue.hpp>
+#include <boost/simulation/pdevs/fel/adaptive_queue.hpp>
+#include <boost/simulation/pdevs/basic_models/generator.hpp>
+#include <boost/simulation/convenience.hpp>
+
+using namespace boost::simulation;
+using namespace boost::simulation::pdevs;
+using namespace boost::simulation::pdevs::basic_models;
+using namespace std;
+
+using Time=fixed_time<1000>;
+using Message=int;
+using item=pair<Time, int>;
+using comp=bool(*)(const item&, const item&);
+
+namespace {
+bool later(const item& lhs, const item& rhs){ return lhs.first > rhs.first; }
+
+//schedules random events never before the top, checks they come out in the same order than from a priority_queue
+//calls between(queue, i) before each operation
+template<class QUEUE, class BETWEEN>
+void check_orders_as_priority_queue(QUEUE& fel, BETWEEN between){
+    priority_queue_vector<item, comp> queue(later);
+    mt19937_64 gen(42);
+    Time now{0};
+    for (int i = 0; i < 20000; i++){
+        between(fel, i);
+        if (queue.empty() || gen() % 3 != 0){
+            int64_t horizon = (i % 3 == 0 ? 3 : (i % 3 == 1 ? 1000 : int64_t(1) << 40));
+            Time t = now + Time::from_ticks(gen() % horizon);
+            fel.emplace(t, i);
+            queue.emplace(t, i);
+        } else {
+            BOOST_REQUIRE( fel.top().first == queue.top().first);
+            now = fel.top().first;
+            fel.pop();
+            queue.pop();
+        }
+        BOOST_REQUIRE_EQUAL( fel.size(), queue.size());
+    }
+    while (!queue.empty()){
+        BOOST_REQUIRE( fel.top().first == queue.top().first);
+        fel.pop();
+        queue.pop();
+    }
+    BOOST_CHECK( fel.empty());
+}
+}
+
+BOOST_AUTO_TEST_SUITE( adaptive_queue_test_suite )
+
+BOOST_AUTO_TEST_CASE( calendar_queue_orders_as_priority_queue_test )
+{
+    calendar_queue<item, comp> calendar(later);
+    check_orders_as_priority_queue(calendar, [](calendar_queue<item, comp>&, int){});
+}
+
+BOOST_AUTO_TEST_CASE( adaptive_queue_orders_as_priority_queue_test )
+{
+    //force every strategy while the queue holds events
+    using queue_type=adaptive_queue<item, comp>;
+    queue_type adaptive(later);
+    check_orders_as_priority_queue(adaptive, [](queue_type& q, int i){
+        if (i % 1000 == 0) q.switch_to(static_cast<queue_type::strategy>((i / 1000) % 3));
+    });
+}
+
+BOOST_AUTO_TEST_CASE( adaptive_queue_selects_strategy_test )
+{
+    using queue_type=adaptive_queue<item, comp>;
+    //few events stay in linear scan
+    queue_type small(later);
+    for (int i = 0; i < 1000; i++){
+        small.emplace(Time::from_ticks(i % 10), i);
+        small.pop();
+    }
+    BOOST_CHECK( small.current_strategy() == queue_type::strategy::linear);
+    //many events at distinct times move to calendar
+    queue_type sparse(later);
+    for (int i = 0; i < 4096; i++) sparse.emplace(Time::from_ticks(i), i);
+    for (int i = 0; i < 8192; i++){
+        Time t = sparse.top().first;
+        sparse.pop();
+        sparse.emplace(t + Time::from_ticks(4096), i);
+    }
+    BOOST_CHECK( sparse.current_strategy() == queue_type::strategy::calendar);
+    //many events sharing few times move back to linear scan
+    sparse.switch_to(queue_type::strategy::heap);
+    for (int i = 0; i < 16384; i++){
+        Time t = sparse.top().first;
+        sparse.pop();
+        sparse.emplace(Time::from_ticks((t.ticks() / 65536 + 1) * 65536), i);
+    }
+    BOOST_CHECK( sparse.current_strategy() == queue_type::strategy::linear);
+}
+
+BOOST_AUTO_TEST_CASE( adaptive_queue_coordinated_generators_test )
+{
+    //create 3 generators with different periods, coordinate them using the adaptive_queue
+    //check the next times and outputs are the ones of the priority_queue_vector coordinator.
+    auto pa1 = make_atomic_ptr<generator<Time, Message>, Time, Message>(Time{1}, 1);
+    auto pa2 = make_atomic_ptr<generator<Time, Message>, Time, Message>(Time{0.3}, 2);
+    auto pa3 = make_atomic_ptr<generator<Time, Message>, Time, Message>(Time{300}, 3);
+    auto cm = std::shared_ptr<coupled<Time, Message>>(new coupled<Time, Message>{{pa1, pa2, pa3}, {}, {}, {pa1, pa2, pa3}});
+
+    coordinator<Time, Message, adaptive_queue> ca{cm};
+    coordinator<Time, Message, priority_queue_vector> cq{cm};
+    Time ta = ca.init(Time{0});
+    Time tq = cq.init(Time{0});
+    while (tq < Time{600}){
+        BOOST_REQUIRE( ta == tq);
+        auto ra = ca.step(ta);
+        auto rq = cq.step(tq);
+        BOOST_REQUIRE_EQUAL( ra.size(), rq.size());
+        BOOST_CHECK( is_permutation(ra.begin(), ra.end(), rq.begin()));
+        ta = ca.next();
+        tq = cq.next();
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,190 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <boost/simulation/fixed_time.hpp>
+#include <boost/simulation/pdevs/atomic_array.hpp>
+#include <boost/simulation/pdevs/coordinator.hpp>
+#include <boost/simulation/pdevs/basic_models/generator.hpp>
+#include <boost/simulation/convenience.hpp>
+
+using namespace boost::simulation;
+using namespace boost::simulation::pdevs;
+using namespace boost::simulation::pdevs::basic_models;
+using namespace std;
+
+using Time=fixed_time<1000>;
+using Message=int;
+using models=vector<shared_ptr<model<Time>>>;
+using couplings=vector<pair<shared_ptr<model<Time>>, shared_ptr<model<Time>>>>;
+using edges=vector<pair<uint32_t, uint32_t>>;
+
+namespace {
+//ticks with its period, outputs the ticks plus the sum of its input, input does not reschedule it
+class pinger : public pdevs::atomic<Time, Message>
+{
+    Time _period, _sigma;
+    int _acc = 0, _count = 0;
+public:
+    explicit pinger(Time period) noexcept : _period(period), _sigma(period) {}
+    void internal() noexcept { _count++; _sigma = _period; }
+    Time advance() const noexcept { return _sigma; }
+    vector<Message> out() const noexcept { return {_count + _acc}; }
+    void external(const vector<Message>& mb, const Time& e) noexcept {
+        for (int m : mb) _acc += m;
+        _sigma = _sigma - e;
+    }
+    void confluence(const vector<Message>& mb, const Time&) noexcept {
+        internal();
+        external(mb, Time(0));
+    }
+};
+
+//the pinger in columns
+struct pinger_kernel
+{
+    using time_type=Time;
+    using message_type=Message;
+    vector<Time> period, sigma;
+    vector<int> acc, count;
+    size_t internal_calls = 0;
+    mutable size_t out_calls = 0;
+
+    explicit pinger_kernel(const vector<Time>& periods) : period(periods), sigma(periods), acc(periods.size(), 0), count(periods.size(), 0) {}
+    size_t size() const noexcept { return period.size(); }
+    Time advance(uint32_t i) const noexcept { return sigma[i]; }
+    void internal(const uint32_t* is, size_t k, Time* ta) noexcept {
+        internal_calls++;
+        for (size_t j = 0; j < k; j++){
+            count[is[j]]++;
+            sigma[is[j]] = period[is[j]];
+            ta[j] = sigma[is[j]];
+        }
+    }
+    Time external(uint32_t i, const vector<Message>& mb, const Time& e) noexcept {
+        for (int m : mb) acc[i] += m;
+        sigma[i] = sigma[i] - e;
+        return sigma[i];
+    }
+    Time confluence(uint32_t i, const vector<Message>& mb) noexcept {
+        count[i]++;
+        sigma[i] = period[i];
+        return external(i, mb, Time(0));
+    }
+    void out(uint32_t i, vector<Message>& bag) const noexcept {
+        out_calls++;
+        bag.push_back(count[i] + acc[i]);
+    }
+};
+
+vector<int> sorted(vector<Message> bag){
+    sort(bag.begin(), bag.end());
+    return bag;
+}
+}
+
+BOOST_AUTO_TEST_CASE( atomic_array_matches_coupled_atomic_models_test )
+{
+    //20 pingers with few distinct periods, so there are confluent transitions, coupled in a ring and by
+    //jumps, a generator sends to two of them and three of them send to the output.
+    //The array of pingers and the pingers as atomic models produce the same bags at the same times.
+    const uint32_t n = 20;
+    vector<Time> periods;
+    edges ic;
+    for (uint32_t i = 0; i < n; i++){
+        periods.push_back(Time(1 + i % 4));
+        ic.emplace_back(i, (i + 1) % n);
+        ic.emplace_back(i, (i * 7) % n);
+    }
+    vector<uint32_t> eic{0, 5}, eoc{3, 10, 19};
+
+    auto gen_a = make_atomic_ptr<generator<Time, Message>, Time, Message>(Time(3), 100);
+    auto array = make_atomic_ptr<atomic_array<pinger_kernel>>(pinger_kernel{periods}, eic, ic, eoc);
+    shared_ptr<coupled<Time, Message>> with_array{ new coupled<Time, Message>{{gen_a, array}, {}, {{gen_a, array}}, {array}} };
+
+    auto gen_b = make_atomic_ptr<generator<Time, Message>, Time, Message>(Time(3), 100);
+    models ms{gen_b}, outs;
+    for (uint32_t i = 0; i < n; i++) ms.push_back(make_atomic_ptr<pinger>(periods[i]));
+    couplings cs;
+    for (uint32_t i : eic) cs.emplace_back(gen_b, ms[1 + i]);
+    for (auto& c : ic) cs.emplace_back(ms[1 + c.first], ms[1 + c.second]);
+    for (uint32_t i : eoc) outs.push_back(ms[1 + i]);
+    shared_ptr<coupled<Time, Message>> with_atomics{ new coupled<Time, Message>{ms, {}, cs, outs} };
+
+    coordinator<Time, Message, priority_queue_vector> ca{with_array};
+    coordinator<Time, Message, priority_queue_vector> cb{with_atomics};
+    Time ta = ca.init(Time(0));
+    Time tb = cb.init(Time(0));
+    BOOST_REQUIRE_EQUAL( ta, tb);
+    size_t outputs = 0;
+    for (int i = 0; i < 40; i++){
+        auto oa = sorted(ca.step(ta));
+        auto ob = sorted(cb.step(tb));
+        BOOST_CHECK_EQUAL_COLLECTIONS( oa.begin(), oa.end(), ob.begin(), ob.end());
+        outputs += ob.size();
+        ta = ca.next();
+        tb = cb.next();
+        BOOST_REQUIRE_EQUAL( ta, tb);
+    }
+    BOOST_CHECK_GT( outputs, 0u);
+}
+
+BOOST_AUTO_TEST_CASE( atomic_array_runs_imminent_elements_in_one_batch_test )
+{
+    //uncoupled pingers with the same period are imminent together, each internal transition of the
+    //array is a single call to the kernel for all of them
+    atomic_array<pinger_kernel> a{pinger_kernel{vector<Time>(1000, Time(2))}, {}, {}, {}};
+    BOOST_CHECK_EQUAL( a.size(), 1000u);
+    BOOST_CHECK_EQUAL( a.advance(), Time(2));
+    for (int i = 0; i < 5; i++){
+        BOOST_CHECK( a.out().empty()); //no element sends to the output
+        a.internal();
+        BOOST_CHECK_EQUAL( a.advance(), Time(2));
+    }
+    BOOST_CHECK_EQUAL( a.kernel().internal_calls, 5u);
+    BOOST_CHECK_EQUAL( a.kernel().count[999], 5);
+}
+
+BOOST_AUTO_TEST_CASE( atomic_array_computes_each_output_once_test )
+{
+    //element 0 sends to element 1 and to the output, element 2 only to the output and element 1 nowhere
+    //the bag of each imminent element is computed once per transition, and is the same for both
+    atomic_array<pinger_kernel> a{pinger_kernel{vector<Time>(3, Time(2))}, {}, {{0, 1}}, {0, 2}};
+    for (int i = 1; i <= 5; i++){
+        auto bag = sorted(a.out());
+        a.internal();
+        BOOST_CHECK_EQUAL( a.kernel().out_calls, 2u * i);
+        BOOST_REQUIRE_EQUAL( bag.size(), 2u);
+        BOOST_CHECK_EQUAL( a.kernel().acc[1], i * (i - 1) / 2); //element 0 sent its tick count to element 1
+    }
+    //without asking for the output first, only the bag sent to element 1 is computed
+    a.internal();
+    BOOST_CHECK_EQUAL( a.kernel().out_calls, 11u);
+}
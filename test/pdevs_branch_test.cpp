@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+#include <memory>
+#include <stdexcept>
+#include <boost/simulation/fixed_time.hpp>
+#include <boost/simulation/convenience.hpp>
+#include <boost/simulation/pdevs/branch.hpp>
+#include <boost/simulation/pdevs/basic_models/generator.hpp>
+#include <boost/simulation/pdevs/basic_models/processor.hpp>
+
+using namespace boost::simulation;
+using namespace boost::simulation::pdevs;
+using namespace boost::simulation::pdevs::basic_models;
+using namespace std;
+
+using Time=fixed_time<1>;
+using Message=int;
+
+namespace {
+//a generator sending a job every 3 to a processor taking 2 per job, the input also goes to the processor
+shared_ptr<coupled<Time, Message>> warm_queue(){
+    auto g = make_atomic_ptr<generator<Time, Message>>(Time{3}, 1);
+    auto p = make_atomic_ptr<processor<Time, Message>>(Time{2});
+    return make_shared<coupled<Time, Message>>(vector<shared_ptr<model<Time>>>{g, p}, vector<shared_ptr<model<Time>>>{p},
+        vector<pair<shared_ptr<model<Time>>, shared_ptr<model<Time>>>>{{g, p}}, vector<shared_ptr<model<Time>>>{p});
+}
+
+void print(ostream& os, Message m){ os << m; }
+
+//the branch i injects a burst of i jobs at 10 and runs until 40
+string what_if(size_t i, runner<Time, Message>& r){
+    r.inject(vector<Message>(i, 100 + static_cast<Message>(i)), Time{10});
+    r.runUntil(Time{40});
+    return "";
+}
+
+//output of branch i simulated from the start
+string from_scratch(size_t i){
+    ostringstream oss;
+    runner<Time, Message> r(warm_queue(), Time{0}, oss, print);
+    r.runUntil(Time{10});
+    string warm = oss.str();
+    what_if(i, r);
+    return oss.str().substr(warm.size());
+}
+}
+
+BOOST_AUTO_TEST_SUITE( branch_test_suite )
+
+BOOST_AUTO_TEST_CASE( branches_match_simulations_from_scratch_test )
+{
+    for (size_t processes : {0, 1, 2}){
+        ostringstream oss;
+        runner<Time, Message> r(warm_queue(), Time{0}, oss, print);
+        auto results = branch(r, Time{10}, 4, [&oss](size_t i, runner<Time, Message>& b){
+            size_t warm = oss.str().size();
+            what_if(i, b);
+            return oss.str().substr(warm);
+        }, processes);
+        BOOST_REQUIRE_EQUAL( results.size(), 4u );
+        for (size_t i = 0; i < 4; i++) BOOST_CHECK_EQUAL( results[i], from_scratch(i) );
+        BOOST_CHECK( results[0] != results[3] );
+    }
+}
+
+BOOST_AUTO_TEST_CASE( branches_do_not_change_the_parent_test )
+{
+    ostringstream oss;
+    runner<Time, Message> r(warm_queue(), Time{0}, oss, print);
+    branch(r, Time{10}, 3, [](size_t i, runner<Time, Message>& b){
+        what_if(i + 1, b);
+        return string{};
+    });
+    BOOST_CHECK_EQUAL( r.next(), Time{11} );
+    r.runUntil(Time{40});
+
+    ostringstream expected;
+    runner<Time, Message> s(warm_queue(), Time{0}, expected, print);
+    s.runUntil(Time{40});
+    BOOST_CHECK_EQUAL( oss.str(), expected.str() );
+}
+
+BOOST_AUTO_TEST_CASE( failing_branches_are_reported_test )
+{
+    runner<Time, Message> r(warm_queue(), Time{0});
+    BOOST_CHECK_THROW( branch(r, Time{10}, 3, [](size_t i, runner<Time, Message>&) -> string {
+        if (i == 1) throw logic_error("intervention failed");
+        return "done";
+    }), runtime_error );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,144 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <boost/simulation/fixed_time.hpp>
+#include <boost/simulation/pdevs/cell_devs.hpp>
+#include <boost/simulation/pdevs/coordinator.hpp>
+#include <boost/simulation/pdevs/basic_models/generator.hpp>
+#include <boost/simulation/convenience.hpp>
+
+using namespace boost::simulation;
+using namespace boost::simulation::pdevs;
+using namespace boost::simulation::pdevs::basic_models;
+using namespace std;
+
+using Time=fixed_time<1000>;
+using Message=int;
+
+namespace {
+//Conway's game of life, the first neighbor is the cell itself
+struct life
+{
+    using time_type=Time;
+    using message_type=Message;
+    using state_type=int;
+    int local(uint32_t, const neighborhood<int>& n) const noexcept {
+        int alive = 0;
+        for (size_t k = 1; k < n.size(); k++) alive += n[k];
+        return (alive == 3 || (alive == 2 && n[0] == 1)) ? 1 : 0;
+    }
+    pair<uint32_t, int> in(const Message& m) const noexcept { return {static_cast<uint32_t>(m), 1}; }
+    Message out(uint32_t cell, const int&) const noexcept { return static_cast<Message>(cell); }
+};
+
+//a cell starts burning when a neighbor burns, the input ignites the cell it names
+struct fire
+{
+    using time_type=Time;
+    using message_type=Message;
+    using state_type=int;
+    size_t evaluations = 0;
+    int local(uint32_t, const neighborhood<int>& n) noexcept {
+        evaluations++;
+        return (n[0] == 1 || any_of(n.begin(), n.end(), [](int s){ return s == 1; })) ? 1 : 0;
+    }
+    pair<uint32_t, int> in(const Message& m) const noexcept { return {static_cast<uint32_t>(m), 1}; }
+    Message out(uint32_t cell, const int&) const noexcept { return static_cast<Message>(cell); }
+};
+}
+
+BOOST_AUTO_TEST_CASE( cell_devs_neighborhoods_test )
+{
+    stencil m2 = moore(2);
+    BOOST_CHECK_EQUAL( m2.size(), 9u);
+    BOOST_CHECK( m2[0] == vector<int>({0, 0}));
+    BOOST_CHECK_EQUAL( moore(3).size(), 27u);
+    BOOST_CHECK_EQUAL( moore(2, 2).size(), 25u);
+    stencil v2 = von_neumann(2);
+    BOOST_CHECK_EQUAL( v2.size(), 5u);
+    BOOST_CHECK( v2[0] == vector<int>({0, 0}));
+    BOOST_CHECK_EQUAL( von_neumann(3, 2).size(), 25u);
+    //no repeated neighbors
+    sort(m2.begin(), m2.end());
+    BOOST_CHECK( adjacent_find(m2.begin(), m2.end()) == m2.end());
+}
+
+BOOST_AUTO_TEST_CASE( cell_devs_blinker_oscillates_test )
+{
+    //a blinker in a 5x5 torus alternates between a row and a column every delay
+    vector<int> initial(25, 0);
+    for (size_t c = 1; c < 4; c++) initial[2 * 5 + c] = 1;
+    cell_space<life> s{life{}, {5, 5}, moore(2), initial, Time(1), {}};
+    auto row = [&s](){ return s.state(s.index({2, 1})) == 1 && s.state(s.index({2, 3})) == 1 && s.state(s.index({1, 2})) == 0; };
+    auto column = [&s](){ return s.state(s.index({1, 2})) == 1 && s.state(s.index({3, 2})) == 1 && s.state(s.index({2, 1})) == 0; };
+    BOOST_CHECK( row());
+    for (int i = 0; i < 4; i++){
+        BOOST_REQUIRE_EQUAL( s.advance(), Time(1));
+        s.internal();
+        BOOST_CHECK( (i % 2 == 0) ? column() : row());
+        int alive = 0;
+        for (uint32_t c = 0; c < s.size(); c++) alive += s.state(c);
+        BOOST_CHECK_EQUAL( alive, 3);
+    }
+    //centered in a corner, the blinker wraps around the edges
+    vector<int> corner(25, 0);
+    corner[4] = corner[0] = corner[1] = 1;
+    cell_space<life> w{life{}, {5, 5}, moore(2), corner, Time(1), {}};
+    w.internal();
+    BOOST_CHECK( w.state(w.index({4, 0})) == 1 && w.state(w.index({0, 0})) == 1 && w.state(w.index({1, 0})) == 1);
+    BOOST_CHECK( w.state(w.index({0, 4})) == 0 && w.state(w.index({0, 1})) == 0);
+}
+
+BOOST_AUTO_TEST_CASE( cell_devs_fire_spreads_only_through_active_cells_test )
+{
+    //a line of 10 cells bounded by unburnable border, a generator ignites the first one at time 5
+    //the fire reaches the last cell, the output of the space, 9 delays later
+    auto gen = make_atomic_ptr<generator<Time, Message>, Time, Message>(Time(5), 0);
+    auto space = make_atomic_ptr<cell_space<fire>>(fire{}, vector<size_t>{10}, von_neumann(1), vector<int>(10, 0), Time(1), vector<uint32_t>{9}, 0);
+    shared_ptr<coupled<Time, Message>> top{ new coupled<Time, Message>{{gen, space}, {}, {{gen, space}}, {space}} };
+    coordinator<Time, Message, priority_queue_vector> c{top};
+    Time t = c.init(Time(0));
+    Time burnt = Time::Inf();
+    while (t < Time(30)){
+        auto out = c.step(t);
+        if (!out.empty() && burnt == Time::Inf()){
+            BOOST_CHECK_EQUAL( out.size(), 1u);
+            BOOST_CHECK_EQUAL( out[0], 9);
+            burnt = t;
+        }
+        t = c.next();
+    }
+    BOOST_CHECK_EQUAL( burnt, Time(14));
+    //every cell once at start, then only the cells next to a change: 2 for each of the 5 inputs to
+    //the first cell, 3 for each cell ignited by a neighbor but the last one, which has a single neighbor
+    auto& s = static_cast<const cell_space<fire>&>(*space);
+    BOOST_CHECK_EQUAL( s.rule().evaluations, 10u + 2 * 5 + 3 * 8 + 2);
+}
@@ -27,12 +27,15 @@
 
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/unit_test.hpp>
+#include <boost/simulation/fixed_time.hpp>
 #include <boost/mpl/vector.hpp>
 #include <boost/mpl/at.hpp>
 #include <boost/mpl/quote.hpp>
 #include <boost/mpl/protect.hpp>
 #include <boost/mpl/bind.hpp>
 #include <boost/mpl/list.hpp>
+#include <algorithm>
+#include <iterator>
 
 
 #include <boost/simulation/pdevs/coupled.hpp>
@@ -40,7 +43,7 @@
 #include <boost/simulation/pdevs/basic_models/generator.hpp>
 #include <boost/simulation/pdevs/basic_models/infinite_counter.hpp>
 #include <boost/simulation/pdevs/basic_models/processor.hpp>
-#include <boost/simulation/pdevs/basic_models/istream.hpp>
+#include <boost/simulation/pdevs/basic_models/input_stream.hpp>
 #include <boost/simulation/convenience.hpp>
 
 
@@ -49,15 +52,31 @@ using namespace boost::simulation;
 using namespace boost::simulation::pdevs;
 using namespace boost::simulation::pdevs::basic_models;
 
-using Time=double;
+using Time=fixed_time<1>;
 using Message=boost::any;
 
 template<class TIME=Time, class MSG=Message>
 class ConfluenceTestHelper : public processor<TIME, MSG>{
 public:
+    static int calls; //confluence calls of all the helpers
     ConfluenceTestHelper(TIME t) : processor<TIME, MSG>(t){}
     void confluence(const std::vector<MSG>& mb, const TIME& t)  noexcept {
-        BOOST_CHECK(false); //, "This function should not be called by the test"); //in confluence now
+        calls++; //in confluence now
+        processor<TIME, MSG>::confluence(mb, t);
+    }
+};
+
+template<class TIME, class MSG>
+int ConfluenceTestHelper<TIME, MSG>::calls = 0;
+
+template<class TIME=Time, class MSG=Message>
+class OutputCountingTestHelper : public generator<TIME, MSG>{
+    std::shared_ptr<int> _calls;
+public:
+    OutputCountingTestHelper(TIME t, std::shared_ptr<int> calls) : generator<TIME, MSG>(t, 1), _calls(calls){}
+    std::vector<MSG> out() const noexcept {
+        (*_calls)++;
+        return generator<TIME, MSG>::out();
     }
 };
 
@@ -192,7 +211,7 @@ BOOST_AUTO_TEST_CASE( generator_send_to_infinite_counter_manual_reset_test )
     //input
     std::shared_ptr<std::istringstream> piss{ new std::istringstream{} };
     piss->str(" 3 0 ");
-    auto pf = make_atomic_ptr<istream<Time, Message, int, int>, std::shared_ptr<std::istringstream>, Time>(piss, Time(0));
+    auto pf = make_atomic_ptr<input_stream<Time, Message, int, int>, std::shared_ptr<std::istringstream>, Time>(piss, Time(0));
 
     //couple them
     auto cm = std::shared_ptr<coupled<Time, Message>>(new coupled<Time, Message>{{pg, pic, pf}, {}, {{pg, pic}, {pf, pic}}, {pic}});
@@ -259,6 +278,180 @@ BOOST_AUTO_TEST_CASE( generators_send_to_infinite_counter_test )
     BOOST_CHECK_EQUAL( boost::any_cast<int>(reply[0]), 2);
 }
 
+BOOST_AUTO_TEST_CASE( output_computed_once_per_transition_test )
+{
+    //create a generator connected to the output and to a processor
+    auto calls = std::make_shared<int>(0);
+    std::shared_ptr<atomic<Time, Message>> pg{ new OutputCountingTestHelper<Time, Message>{Time{1}, calls} };
+    std::shared_ptr<atomic<Time, Message>> pp{ new processor<Time, Message>{Time{2}} };
+    //couple them
+    auto cm = std::shared_ptr<coupled<Time, Message>>(new coupled<Time, Message>{{pg, pp}, {}, {{pg, pp}}, {pg}});
+    //coordinate
+    auto c = std::shared_ptr<coordinator<Time, Message, priority_queue_vector>>( new coordinator<Time, Message, priority_queue_vector>(cm));
+    Time t = c->init(Time{0});
+    BOOST_CHECK_EQUAL( t, Time{1});
+
+    //at time 1 the output is collected twice and routed to the processor
+    auto reply = c->collectOutputs(t);
+    BOOST_REQUIRE_EQUAL( reply.size(), 1);
+    reply = c->collectOutputs(t);
+    BOOST_REQUIRE_EQUAL( reply.size(), 1);
+    c->advanceSimulation( Time{1});
+    BOOST_CHECK_EQUAL( *calls, 1);
+
+    //at time 2 a new transition requires a new output
+    t = c->next();
+    BOOST_CHECK_EQUAL( t, Time{2});
+    reply = c->collectOutputs(t);
+    c->advanceSimulation( Time{2});
+    BOOST_CHECK_EQUAL( *calls, 2);
+}
+
+BOOST_AUTO_TEST_CASE( messages_routed_directly_between_simulators_test )
+{
+    //create a generator and an infinite_counter, each inside its own coupled model, connected in the upper level
+    std::shared_ptr<atomic<Time, Message>> pg{ new generator<Time, Message>{Time{1}, 1} };
+    std::shared_ptr<atomic<Time, Message>> pic{ new infinite_counter<Time, Message>{} };
+    auto cm1 = std::shared_ptr<coupled<Time, Message>>(new coupled<Time, Message>{{pg}, {}, {}, {pg}});
+    auto cm2 = std::shared_ptr<coupled<Time, Message>>(new coupled<Time, Message>{{pic}, {pic}, {}, {}});
+    auto cm = std::shared_ptr<coupled<Time, Message>>(new coupled<Time, Message>{{cm1, cm2}, {}, {{cm1, cm2}}, {}});
+    //coordinate tracing the routes
+    using observer=tracing_observer<Time, Message>;
+    observer::reset();
+    coordinator<Time, Message, priority_queue_vector, tracing_observer> c{cm};
+    Time t = c.init(Time{0});
+    BOOST_CHECK_EQUAL( t, Time{1});
+
+    //at time 1 the message goes from the generator to the counter without passing through the coupled models
+    c.step(t);
+    std::vector<observer::event> routes;
+    std::copy_if(observer::trace.begin(), observer::trace.end(), std::back_inserter(routes),
+                 [](const observer::event& e){ return e.kind == observer::event_kind::route; });
+    BOOST_REQUIRE_EQUAL( routes.size(), 1);
+    BOOST_CHECK( routes[0].from == pg.get());
+    BOOST_CHECK( routes[0].to == pic.get());
+    BOOST_CHECK( std::any_of(observer::trace.begin(), observer::trace.end(), [&pic](const observer::event& e){
+        return e.kind == observer::event_kind::external && e.from == pic.get(); }));
+}
+
+BOOST_AUTO_TEST_CASE( passive_subtree_built_on_first_input_test )
+{
+    //a generator sending to a processor inside a coupled model, the processor starts passive
+    auto build = [](){
+        std::shared_ptr<atomic<Time, Message>> pg{ new generator<Time, Message>{Time{2}, 1} };
+        std::shared_ptr<atomic<Time, Message>> pp{ new processor<Time, Message>{Time{1}} };
+        auto cm1 = std::shared_ptr<coupled<Time, Message>>(new coupled<Time, Message>{{pp}, {pp}, {}, {pp}});
+        return std::shared_ptr<coupled<Time, Message>>(new coupled<Time, Message>{{pg, cm1}, {}, {{pg, cm1}}, {cm1}});
+    };
+    //the lazy coordinator forwards the first message through the stub of the coupled model
+    using observer=tracing_observer<Time, Message>;
+    observer::reset();
+    coordinator<Time, Message, priority_queue_vector, tracing_observer> cl{build(), 1, true};
+    coordinator<Time, Message, priority_queue_vector> ce{build()};
+    Time tl = cl.init(Time{0});
+    Time te = ce.init(Time{0});
+    BOOST_CHECK_EQUAL( tl, Time{2});
+    for (int i = 0; i < 10; i++){
+        BOOST_REQUIRE_EQUAL( tl, te);
+        BOOST_CHECK_EQUAL( cl.step(tl).size(), ce.step(te).size());
+        tl = cl.next();
+        te = ce.next();
+    }
+    BOOST_CHECK( std::any_of(observer::trace.begin(), observer::trace.end(), [](const observer::event& e){
+        return e.kind == observer::event_kind::route && dynamic_cast<const coupled<Time, Message>*>(e.from) != nullptr; }));
+}
+
+BOOST_AUTO_TEST_CASE( parallel_build_matches_sequential_build_test )
+{
+    //eight coupled models holding a generator and a processor each, generators connected to the top level output,
+    //idle processors make the model large enough to be built with threads
+    auto build = [](){
+        std::vector<std::shared_ptr<model<Time>>> groups;
+        std::vector<std::shared_ptr<model<Time>>> eoc;
+        for (int i = 1; i <= 8; i++){
+            std::shared_ptr<atomic<Time, Message>> pg{ new generator<Time, Message>{Time(i), i} };
+            std::shared_ptr<atomic<Time, Message>> pp{ new processor<Time, Message>{Time{3}} };
+            std::vector<std::shared_ptr<model<Time>>> ms{pg, pp};
+            for (std::size_t k = 0; k < coordinator<Time, Message, priority_queue_vector>::parallel_threshold / 8; k++){
+                ms.push_back(std::make_shared<processor<Time, Message>>(Time{3}));
+            }
+            std::shared_ptr<coupled<Time, Message>> cm{ new coupled<Time, Message>{ms, {}, {{pg, pp}}, {pg}} };
+            groups.push_back(cm);
+            eoc.push_back(cm);
+        }
+        return std::shared_ptr<coupled<Time, Message>>(new coupled<Time, Message>{groups, {}, {}, eoc});
+    };
+    //build and initialize one coordinator sequentially and another one using four threads
+    coordinator<Time, Message, priority_queue_vector> cs{build()};
+    coordinator<Time, Message, priority_queue_vector> cp{build(), 4};
+    Time ts = cs.init(Time{0});
+    Time tp = cp.init(Time{0}, 4);
+    BOOST_CHECK_EQUAL( ts, Time{1});
+    BOOST_CHECK_EQUAL( tp, ts);
+    //both produce the same outputs at the same times
+    for (int i = 0; i < 20; i++){
+        BOOST_CHECK_EQUAL( cp.step(tp).size(), cs.step(ts).size());
+        ts = cs.next();
+        tp = cp.next();
+        BOOST_REQUIRE_EQUAL( tp, ts);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( reordered_build_matches_description_order_test )
+{
+    //chains of a generator and two processors listed interleaved in the description, four of them in
+    //the top level and four in a flattened submodel, so both ways of building a level are reordered
+    using models=std::vector<std::shared_ptr<model<Time>>>;
+    using couplings=std::vector<std::pair<std::shared_ptr<model<Time>>, std::shared_ptr<model<Time>>>>;
+    auto chains = [](int first, models& ms, couplings& ic, models& eoc){
+        models gs, ps, qs;
+        for (int i = first; i < first + 4; i++){
+            gs.emplace_back(new generator<Time, Message>{Time(i), i});
+            ps.emplace_back(new processor<Time, Message>{Time{1}});
+            qs.emplace_back(new processor<Time, Message>{Time{2}});
+            ic.emplace_back(gs.back(), ps.back());
+            ic.emplace_back(ps.back(), qs.back());
+            eoc.push_back(qs.back());
+        }
+        ms.insert(ms.end(), qs.begin(), qs.end());
+        ms.insert(ms.end(), gs.begin(), gs.end());
+        ms.insert(ms.end(), ps.begin(), ps.end());
+    };
+    auto build = [&chains](){
+        models ms, flat_ms, eoc, flat_eoc;
+        couplings ic, flat_ic;
+        chains(1, ms, ic, eoc);
+        chains(5, flat_ms, flat_ic, flat_eoc);
+        std::shared_ptr<coupled<Time, Message>> flat{ new flattened_coupled<Time, Message>{flat_ms, {}, flat_ic, flat_eoc} };
+        ms.push_back(flat);
+        eoc.push_back(flat);
+        return std::shared_ptr<coupled<Time, Message>>(new coupled<Time, Message>{ms, {}, ic, eoc});
+    };
+    coordinator<Time, Message, priority_queue_vector> cd{build()};
+    coordinator<Time, Message, priority_queue_vector> cr{build(), 1, false, true};
+    Time td = cd.init(Time{0});
+    Time tr = cr.init(Time{0});
+    BOOST_CHECK_EQUAL( tr, td);
+    //both produce the same bags at the same times, the order of the messages in a bag may differ
+    auto values = [](const std::vector<Message>& bag){
+        std::vector<int> v;
+        for (auto& m : bag) v.push_back(boost::any_cast<int>(m));
+        std::sort(v.begin(), v.end());
+        return v;
+    };
+    std::size_t outputs = 0;
+    for (int i = 0; i < 30; i++){
+        auto od = values(cd.step(td));
+        auto orr = values(cr.step(tr));
+        BOOST_CHECK_EQUAL_COLLECTIONS( orr.begin(), orr.end(), od.begin(), od.end());
+        outputs += od.size();
+        td = cd.next();
+        tr = cr.next();
+        BOOST_REQUIRE_EQUAL( tr, td);
+    }
+    BOOST_CHECK_GT( outputs, 0u);
+}
+
 BOOST_AUTO_TEST_CASE( something_with_confluence_test )
 {
     //create a generator and a processor, with same time
@@ -279,7 +472,9 @@ BOOST_AUTO_TEST_CASE( something_with_confluence_test )
     BOOST_REQUIRE_EQUAL( reply.size(), 0);
 
     //at time 4
+    ConfluenceTestHelper<>::calls = 0;
     c->advanceSimulation( Time{4}); //check if confluence is called.
+    BOOST_CHECK_EQUAL( ConfluenceTestHelper<>::calls, 1);
 
 }
 
@@ -385,6 +580,33 @@ BOOST_AUTO_TEST_CASE( p_coordinated__multiple_generators_produces_right_output_t
     BOOST_CHECK_EQUAL( std::count_if(reply.begin(), reply.end(), [](boost::any& m) { return boost::any_cast<int>(m) ==  3;}), 1);
 
 
+}
+BOOST_AUTO_TEST_CASE( p_coordinated_multiple_generators_step_test )
+{
+    //create 2 generators into 2 coupled models in cascade.
+    //check step provides the same outputs than collectOutputs followed by advanceSimulation
+
+    std::shared_ptr<atomic<Time, Message>> pa1{ new generator<Time, Message>{Time{1}, 1}};
+    auto cm1 = std::shared_ptr<coupled<Time, Message>>(new coupled<Time, Message>{{pa1}, {}, {}, {pa1}});
+    std::shared_ptr<atomic<Time, Message>> pa2{ new generator<Time, Message>{Time{2}, 2}};
+    auto cm2 = std::shared_ptr<coupled<Time, Message>>(new coupled<Time, Message>{{pa2, cm1}, {}, {}, {pa2, cm1}});
+    auto c = std::shared_ptr<coordinator<Time, boost::any, nullqueue>>( new coordinator<Time, boost::any, nullqueue>(cm2));
+
+    Time t = c->init(Time{0});
+    BOOST_CHECK_EQUAL( t, Time{1} );
+    //at time 1
+    auto reply = c->step(t);
+    t = c->next();
+    BOOST_CHECK_EQUAL( t, Time{2});
+    BOOST_REQUIRE_EQUAL( reply.size(), 1);
+    BOOST_CHECK_EQUAL( boost::any_cast<int>(reply[0]), 1);
+    //at time 2
+    reply = c->step(t);
+    t = c->next();
+    BOOST_CHECK_EQUAL( t, Time{3});
+    BOOST_REQUIRE_EQUAL( reply.size(), 2);
+    BOOST_CHECK_EQUAL( std::count_if(reply.begin(), reply.end(), [](boost::any& m) { return boost::any_cast<int>(m) ==  1;}), 1);
+    BOOST_CHECK_EQUAL( std::count_if(reply.begin(), reply.end(), [](boost::any& m) { return boost::any_cast<int>(m) ==  2;}), 1);
 }
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -399,7 +621,7 @@ BOOST_AUTO_TEST_CASE( generator_send_to_infinite_counter_manual_reset_test )
     //input
     std::shared_ptr<std::istringstream> piss{ new std::istringstream{} };
     piss->str(" 3 0 ");
-    auto pf = make_atomic_ptr<istream<Time, Message, int, int>, std::shared_ptr<std::istringstream>, Time>(piss, Time(0));
+    auto pf = make_atomic_ptr<input_stream<Time, Message, int, int>, std::shared_ptr<std::istringstream>, Time>(piss, Time(0));
 
     //couple them
     auto cm = std::shared_ptr<coupled<Time, Message>>(new coupled<Time, Message>{{pg, pic, pf}, {}, {{pg, pic}, {pf, pic}}, {pic}});
@@ -466,6 +688,35 @@ BOOST_AUTO_TEST_CASE( generators_send_to_infinite_counter_test )
     BOOST_CHECK_EQUAL( boost::any_cast<int>(reply[0]), 2);
 }
 
+BOOST_AUTO_TEST_CASE( output_computed_once_per_transition_test )
+{
+    //create a generator connected to the output and to a processor
+    auto calls = std::make_shared<int>(0);
+    std::shared_ptr<atomic<Time, Message>> pg{ new OutputCountingTestHelper<Time, Message>{Time{1}, calls} };
+    std::shared_ptr<atomic<Time, Message>> pp{ new processor<Time, Message>{Time{2}} };
+    //couple them
+    auto cm = std::shared_ptr<coupled<Time, Message>>(new coupled<Time, Message>{{pg, pp}, {}, {{pg, pp}}, {pg}});
+    //coordinate
+    auto c = std::shared_ptr<coordinator<Time, Message, nullqueue>>( new coordinator<Time, Message, nullqueue>(cm));
+    Time t = c->init(Time{0});
+    BOOST_CHECK_EQUAL( t, Time{1});
+
+    //at time 1 the output is collected twice and routed to the processor
+    auto reply = c->collectOutputs(t);
+    BOOST_REQUIRE_EQUAL( reply.size(), 1);
+    reply = c->collectOutputs(t);
+    BOOST_REQUIRE_EQUAL( reply.size(), 1);
+    c->advanceSimulation( Time{1});
+    BOOST_CHECK_EQUAL( *calls, 1);
+
+    //at time 2 a new transition requires a new output
+    t = c->next();
+    BOOST_CHECK_EQUAL( t, Time{2});
+    reply = c->collectOutputs(t);
+    c->advanceSimulation( Time{2});
+    BOOST_CHECK_EQUAL( *calls, 2);
+}
+
 BOOST_AUTO_TEST_CASE( something_with_confluence_test )
 {
     //create a generator and a processor, with same time
@@ -486,7 +737,9 @@ BOOST_AUTO_TEST_CASE( something_with_confluence_test )
     BOOST_REQUIRE_EQUAL( reply.size(), 0);
 
     //at time 4
+    ConfluenceTestHelper<>::calls = 0;
     c->advanceSimulation( Time{4}); //check the confluence function is called
+    BOOST_CHECK_EQUAL( ConfluenceTestHelper<>::calls, 1);
 
 }
 
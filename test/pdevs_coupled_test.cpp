@@ -27,17 +27,25 @@
 
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/unit_test.hpp>
+#include <boost/simulation/fixed_time.hpp>
 #include <boost/simulation/pdevs/coupled.hpp>
+#include <boost/simulation/pdevs/compiled_graph.hpp>
+#include <boost/simulation/pdevs/coordinator.hpp>
 #include <boost/simulation/pdevs/basic_models/generator.hpp>
 #include <boost/simulation/pdevs/basic_models/infinite_counter.hpp>
 #include <boost/rational.hpp>
 #include <boost/simulation/convenience.hpp>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include <fstream>
 
 using namespace boost::simulation;
 using namespace boost::simulation::pdevs;
 using namespace boost::simulation::pdevs::basic_models;
 
-using Time=boost::rational<int>;
+using Time=fixed_time<1>;
 using Message=boost::any;
 BOOST_AUTO_TEST_SUITE( p_coupled_test_suite )
 
@@ -249,4 +257,205 @@ BOOST_AUTO_TEST_SUITE_END()
 
 
 
+BOOST_AUTO_TEST_SUITE( p_flattened_coupled_test_suite )
+BOOST_AUTO_TEST_CASE( p_generators_to_p_infinite_counter_flattened_from_three_levels_test )
+{
+    auto pg1 = make_atomic_ptr<generator<Time, Message>, Time>(Time{1});
+    auto pg2 = make_atomic_ptr<generator<Time, Message>, Time>(Time{1});
+    auto pic = make_atomic_ptr<infinite_counter<Time, Message>>();
+    //pg1 is two levels down, pic one level down
+    auto pc1 = std::shared_ptr<coupled<Time, Message>>( new coupled<Time, Message>{
+        {pg1}, {}, {}, {pg1}
+    });
+    auto pc2 = std::shared_ptr<coupled<Time, Message>>( new coupled<Time, Message>{
+        {pc1}, {}, {}, {pc1}
+    });
+    auto pc3 = std::shared_ptr<coupled<Time, Message>>( new coupled<Time, Message>{
+        {pic}, {pic}, {}, {pic}
+    });
+    flattened_coupled<Time, Message> pf{
+        {pg2, pc2, pc3}, {pc3}, {{pg2, pc3}, {pc2, pc3}}, {pc3}
+    };
+
+    //all atomic models in a single level, couplings as indexes
+    auto& flat = pf.get_flat_description();
+    BOOST_REQUIRE_EQUAL(flat.models.size(), 3);
+    auto index_of = [&flat](std::shared_ptr<model<Time>> m){
+        return std::find(flat.models.begin(), flat.models.end(), m) - flat.models.begin(); };
+    std::size_t ig1 = index_of(pg1), ig2 = index_of(pg2), iic = index_of(pic);
+    BOOST_REQUIRE_EQUAL(flat.coupling_offsets.size(), 4);
+    BOOST_CHECK_EQUAL(flat.coupling_offsets[ig1 + 1] - flat.coupling_offsets[ig1], 1);
+    BOOST_CHECK_EQUAL(flat.coupling_targets[flat.coupling_offsets[ig1]], iic);
+    BOOST_CHECK_EQUAL(flat.coupling_offsets[ig2 + 1] - flat.coupling_offsets[ig2], 1);
+    BOOST_CHECK_EQUAL(flat.coupling_targets[flat.coupling_offsets[ig2]], iic);
+    BOOST_CHECK_EQUAL(flat.coupling_offsets[iic + 1] - flat.coupling_offsets[iic], 0);
+    BOOST_REQUIRE_EQUAL(flat.external_input_coupling.size(), 1);
+    BOOST_CHECK_EQUAL(flat.external_input_coupling[0], iic);
+    BOOST_REQUIRE_EQUAL(flat.external_output_coupling.size(), 1);
+    BOOST_CHECK_EQUAL(flat.external_output_coupling[0], iic);
+
+    //same model as pairs of pointers
+    auto& desc = pf.get_description();
+    BOOST_CHECK_EQUAL(desc.models.size(), 3);
+    BOOST_CHECK_EQUAL(desc.internal_coupling.size(), 2);
+    BOOST_CHECK_EQUAL(std::count_if(desc.internal_coupling.begin(), desc.internal_coupling.end(),
+                                    [&pg1, &pic](const std::pair<std::shared_ptr<model<Time>>, std::shared_ptr<model<Time>>> & coupling){
+                                        return coupling.first == pg1 && coupling.second == pic;})
+                      , 1);
+    BOOST_CHECK_EQUAL(desc.external_input_coupling.size(), 1);
+    BOOST_CHECK_EQUAL(desc.external_output_coupling.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE( p_coupled_models_coupled_to_each_other_through_a_relay_test )
+{
+    using models_type=std::vector<std::shared_ptr<model<Time>>>;
+    using couplings_type=std::vector<std::pair<std::shared_ptr<model<Time>>, std::shared_ptr<model<Time>>>>;
+    //three generators sending to three counters through the ports of their coupled models
+    models_type generators, counters;
+    for (int i = 0; i < 3; i++){
+        generators.push_back(make_atomic_ptr<generator<Time, Message>, Time>(Time{1}));
+        counters.push_back(make_atomic_ptr<infinite_counter<Time, Message>>());
+    }
+    auto senders = std::make_shared<coupled<Time, Message>>(generators, models_type{}, couplings_type{}, generators);
+    auto receivers = std::make_shared<coupled<Time, Message>>(counters, counters, couplings_type{}, counters);
+    auto top = std::make_shared<coupled<Time, Message>>(models_type{senders, receivers}, models_type{}, couplings_type{{senders, receivers}}, models_type{receivers});
+    auto flat = std::make_shared<flattened_coupled<Time, Message>>(models_type{senders, receivers}, models_type{}, couplings_type{{senders, receivers}}, models_type{receivers});
+
+    //each generator sends to the relay, the relay to each counter
+    auto& fd = flat->get_flat_description();
+    BOOST_CHECK_EQUAL(fd.models.size(), 6);
+    BOOST_CHECK_EQUAL(fd.relays(), 1);
+    BOOST_CHECK_EQUAL(fd.coupling_targets.size(), 6);
+    BOOST_CHECK_EQUAL(flat->get_description().internal_coupling.size(), 9);
+
+    //every counter receives from every generator, with and without flattening
+    using counter=counting_observer<Time, Message>;
+    for (auto c : {top, std::static_pointer_cast<coupled<Time, Message>>(flat)}){
+        counter::reset();
+        coordinator<Time, Message, nullqueue, counting_observer> cn{c};
+        cn.init(Time{0});
+        cn.advanceSimulation(Time{1});
+        BOOST_CHECK_EQUAL(counter::counters.routes, 9);
+        counter::reset();
+        coordinator<Time, Message, priority_queue_vector, counting_observer> cf{c};
+        cf.init(Time{0});
+        cf.advanceSimulation(Time{1});
+        BOOST_CHECK_EQUAL(counter::counters.routes, 9);
+    }
+
+    //relays are saved with the graph
+    const std::string path = "compiled_graph_relay_test.bin";
+    BOOST_REQUIRE(compiled_graph::save(*flat, path));
+    auto bound = compiled_graph{path}.bind<Time, Message>([](std::size_t, std::uint64_t) -> std::shared_ptr<atomic<Time, Message>> {
+        return make_atomic_ptr<infinite_counter<Time, Message>>();
+    });
+    std::remove(path.c_str());
+    BOOST_CHECK_EQUAL(bound->get_flat_description().relays(), 1);
+    BOOST_CHECK(bound->get_flat_description().coupling_offsets == fd.coupling_offsets);
+    BOOST_CHECK(bound->get_flat_description().coupling_targets == fd.coupling_targets);
+}
+
+BOOST_AUTO_TEST_CASE( p_flattened_coupled_rejects_couplings_out_of_its_level_test )
+{
+    using models_type=std::vector<std::shared_ptr<model<Time>>>;
+    using couplings_type=std::vector<std::pair<std::shared_ptr<model<Time>>, std::shared_ptr<model<Time>>>>;
+    auto pg = make_atomic_ptr<generator<Time, Message>, Time>(Time{1});
+    auto pic = make_atomic_ptr<infinite_counter<Time, Message>>();
+    auto stranger = make_atomic_ptr<infinite_counter<Time, Message>>();
+    BOOST_CHECK_THROW((flattened_coupled<Time, Message>{models_type{pg, pic}, models_type{}, couplings_type{{pg, stranger}}, models_type{pic}}), std::invalid_argument);
+    BOOST_CHECK_THROW((flattened_coupled<Time, Message>{models_type{pg, pic}, models_type{stranger}, couplings_type{}, models_type{pic}}), std::invalid_argument);
+    BOOST_CHECK_THROW((flattened_coupled<Time, Message>{models_type{pg, pic}, models_type{}, couplings_type{}, models_type{stranger}}), std::invalid_argument);
+    BOOST_CHECK_THROW((flattened_coupled<Time, Message>{models_type{pg, nullptr}, models_type{}, couplings_type{}, models_type{pg}}), std::invalid_argument);
+    BOOST_CHECK_NO_THROW((flattened_coupled<Time, Message>{models_type{pg, pic}, models_type{}, couplings_type{{pg, pic}}, models_type{pic}}));
+}
+
+BOOST_AUTO_TEST_CASE( p_flattened_coupled_saved_and_bound_from_compiled_graph_test )
+{
+    auto pg1 = make_atomic_ptr<generator<Time, Message>, Time>(Time{1});
+    auto pg2 = make_atomic_ptr<generator<Time, Message>, Time>(Time{1});
+    auto pic = make_atomic_ptr<infinite_counter<Time, Message>>();
+    auto pc1 = std::shared_ptr<coupled<Time, Message>>( new coupled<Time, Message>{
+        {pg1}, {}, {}, {pg1}
+    });
+    flattened_coupled<Time, Message> pf{
+        {pg2, pc1, pic}, {pic}, {{pg2, pic}, {pc1, pic}}, {pic}
+    };
+
+    //generators are tagged 1 and counters 2
+    const std::string path = "compiled_graph_test.bin";
+    BOOST_REQUIRE(compiled_graph::save(pf, path, [](std::size_t, const std::shared_ptr<model<Time>>& m){
+        return std::dynamic_pointer_cast<generator<Time, Message>>(m) ? std::uint64_t{1} : std::uint64_t{2}; }));
+
+    //bound to new models, the indexes are the saved ones
+    {
+        compiled_graph cg{path};
+        BOOST_REQUIRE_EQUAL(cg.models(), 3);
+        auto bound = cg.bind<Time, Message>([](std::size_t, std::uint64_t tag) -> std::shared_ptr<atomic<Time, Message>> {
+            if (tag == 1) return make_atomic_ptr<generator<Time, Message>, Time>(Time{1});
+            return make_atomic_ptr<infinite_counter<Time, Message>>();
+        });
+        auto& saved = pf.get_flat_description();
+        auto& loaded = bound->get_flat_description();
+        BOOST_REQUIRE_EQUAL(loaded.models.size(), 3);
+        for (std::size_t i = 0; i < 3; i++){
+            BOOST_CHECK(loaded.models[i] != saved.models[i]);
+            BOOST_CHECK_EQUAL(cg.tag(i), saved.models[i] == pic ? 2 : 1);
+        }
+        BOOST_CHECK(loaded.external_input_coupling == saved.external_input_coupling);
+        BOOST_CHECK(loaded.coupling_offsets == saved.coupling_offsets);
+        BOOST_CHECK(loaded.coupling_targets == saved.coupling_targets);
+        BOOST_CHECK(loaded.external_output_coupling == saved.external_output_coupling);
+    }
+    //a graph bound once gives away its couplings
+    {
+        auto bound = compiled_graph{path}.bind<Time, Message>([](std::size_t, std::uint64_t) -> std::shared_ptr<atomic<Time, Message>> {
+            return make_atomic_ptr<infinite_counter<Time, Message>>();
+        });
+        BOOST_CHECK(bound->get_flat_description().coupling_offsets == pf.get_flat_description().coupling_offsets);
+        BOOST_CHECK(bound->get_flat_description().coupling_targets == pf.get_flat_description().coupling_targets);
+    }
+    //factories have to create every model
+    {
+        compiled_graph cg{path};
+        auto none_for_counters = [](std::size_t, std::uint64_t tag) -> std::shared_ptr<atomic<Time, Message>> {
+            if (tag == 1) return make_atomic_ptr<generator<Time, Message>, Time>(Time{1});
+            return nullptr;
+        };
+        BOOST_CHECK_THROW((cg.bind<Time, Message>(none_for_counters)), std::invalid_argument);
+        BOOST_CHECK_THROW((std::move(cg).bind<Time, Message>(none_for_counters)), std::invalid_argument);
+    }
+
+    //files written with another byte order or word size are rejected
+    std::vector<char> bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    auto write = [&path](const std::vector<char>& b){
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(b.data(), b.size());
+    };
+    std::vector<char> swapped = bytes;
+    for (std::size_t w = 0; w + 8 <= swapped.size(); w += 8) std::reverse(swapped.begin() + w, swapped.begin() + w + 8);
+    write(swapped);
+    BOOST_CHECK_THROW(compiled_graph{path}, std::invalid_argument);
+    std::vector<char> narrow = bytes;
+    const std::uint64_t four = 4;
+    std::memcpy(narrow.data() + 2 * sizeof(std::uint64_t), &four, sizeof(four)); //the word size is the third word
+    write(narrow);
+    BOOST_CHECK_THROW(compiled_graph{path}, std::invalid_argument);
+    write(bytes);
+    BOOST_CHECK_NO_THROW(compiled_graph{path});
+
+    //a file that is not a compiled graph is rejected
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "not a compiled graph, just some text long enough for a header";
+    }
+    BOOST_CHECK_THROW(compiled_graph{path}, std::invalid_argument);
+    std::remove(path.c_str());
+    BOOST_CHECK_THROW(compiled_graph{path}, std::runtime_error);
+}
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,188 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <boost/simulation/fixed_time.hpp>
+#include <boost/simulation/pdevs/ensemble.hpp>
+
+using namespace boost::simulation;
+using namespace boost::simulation::pdevs;
+using namespace std;
+
+using Time=fixed_time<1>;
+using Message=int;
+
+namespace {
+//a source sending jobs at random intervals to a server with random service times, element 0 is the
+//source and 1 the server, each element draws from its own random stream
+struct queue_kernel
+{
+    using time_type=Time;
+    using message_type=Message;
+    size_t lanes;
+    uint32_t scale; //times are drawn from ranges scale times larger
+    vector<uint32_t> rng;
+    vector<Time> sigma;
+    vector<int> queued, served;
+    size_t internal_calls = 0;
+
+    queue_kernel(size_t k, const vector<uint32_t>& seeds, uint32_t s=1) : lanes(k), scale(s), rng(2 * k), sigma(2 * k, Time::Inf()), queued(2 * k, 0), served(2 * k, 0) {
+        for (size_t l = 0; l < k; l++){
+            rng[l] = seeds[l];
+            rng[k + l] = seeds[l] ^ 0x9e3779b9u;
+            sigma[l] = draw(static_cast<uint32_t>(l), 4);
+        }
+    }
+    Time draw(uint32_t i, uint32_t most) noexcept { //xorshift32, uniform in [1, most]
+        uint32_t x = rng[i];
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        rng[i] = x;
+        return Time(static_cast<int>(1 + x % (most * scale)));
+    }
+    size_t size() const noexcept { return 2 * lanes; }
+    Time advance(uint32_t i) const noexcept { return sigma[i]; }
+    Time next_event(uint32_t i) noexcept {
+        if (i < lanes){
+            sigma[i] = draw(i, 4);
+        } else {
+            served[i]++;
+            queued[i]--;
+            sigma[i] = (queued[i] > 0 ? draw(i, 3) : Time::Inf());
+        }
+        return sigma[i];
+    }
+    void internal(const uint32_t* is, size_t k, Time* ta) noexcept {
+        internal_calls++;
+        for (size_t j = 0; j < k; j++) ta[j] = next_event(is[j]);
+    }
+    Time external(uint32_t i, const vector<Message>& mb, const Time& e) noexcept {
+        bool idle = (queued[i] == 0);
+        queued[i] += static_cast<int>(mb.size());
+        sigma[i] = (idle ? draw(i, 3) : sigma[i] - e);
+        return sigma[i];
+    }
+    Time confluence(uint32_t i, const vector<Message>& mb) noexcept {
+        next_event(i);
+        return external(i, mb, Time(0));
+    }
+    void out(uint32_t i, vector<Message>& bag) const noexcept {
+        bag.push_back(static_cast<Message>(i % lanes)); //the lane, jobs and served jobs alike
+    }
+};
+
+//runs the ensemble until the last transition before end
+void run_until(ensemble<queue_kernel>& e, Time end){
+    for (Time t = e.advance(); t <= end; t = t + e.advance()) e.internal();
+}
+
+//runs the ensemble until end sending a job to its input every period
+void run_with_input(ensemble<queue_kernel>& e, Time end, Time period){
+    Time now(0), input = period;
+    for (Time next = e.advance(); next <= end || input <= end; next = now + e.advance()){
+        if (input < next){
+            e.external({1}, input - now);
+            now = input;
+            input = input + period;
+        } else if (next == input){
+            e.confluence({1}, next - now);
+            now = next;
+            input = input + period;
+        } else {
+            e.internal();
+            now = next;
+        }
+    }
+}
+}
+
+BOOST_AUTO_TEST_CASE( ensemble_lanes_match_separate_replications_test )
+{
+    //8 replications with different seeds in lockstep, each lane ends as the same replication run alone
+    const size_t k = 8;
+    vector<uint32_t> seeds;
+    for (size_t l = 0; l < k; l++) seeds.push_back(static_cast<uint32_t>(1 + 7919 * l));
+    ensemble<queue_kernel> all{queue_kernel{k, seeds}, k, {}, {{0, 1}}, {1}};
+    run_until(all, Time(500));
+    int total = 0;
+    for (size_t l = 0; l < k; l++){
+        ensemble<queue_kernel> one{queue_kernel{1, {seeds[l]}}, 1, {}, {{0, 1}}, {1}};
+        run_until(one, Time(500));
+        BOOST_CHECK_EQUAL( all.kernel().served[ensemble<queue_kernel>::index(1, l, k)], one.kernel().served[1]);
+        BOOST_CHECK_EQUAL( all.kernel().queued[ensemble<queue_kernel>::index(1, l, k)], one.kernel().queued[1]);
+        total += one.kernel().served[1];
+    }
+    BOOST_CHECK_GT( total, 0);
+}
+
+BOOST_AUTO_TEST_CASE( ensemble_identical_lanes_share_every_step_test )
+{
+    //lanes with the same seed have the same event times, the ensemble takes the steps of a single lane
+    //and each internal transition is one call to the kernel for all the lanes
+    const size_t k = 16;
+    ensemble<queue_kernel> all{queue_kernel{k, vector<uint32_t>(k, 42)}, k, {}, {{0, 1}}, {1}};
+    ensemble<queue_kernel> one{queue_kernel{1, {42}}, 1, {}, {{0, 1}}, {1}};
+    for (int i = 0; i < 100; i++){
+        BOOST_REQUIRE_EQUAL( all.advance(), one.advance());
+        vector<Message> lanes = all.out();
+        BOOST_CHECK_EQUAL( lanes.size(), k * one.out().size());
+        if (!lanes.empty()){ //every lane outputs once
+            sort(lanes.begin(), lanes.end());
+            BOOST_CHECK_EQUAL( lanes.front(), 0);
+            BOOST_CHECK( adjacent_find(lanes.begin(), lanes.end()) == lanes.end());
+        }
+        all.internal();
+        one.internal();
+    }
+    BOOST_CHECK_EQUAL( all.kernel().internal_calls, one.kernel().internal_calls);
+    BOOST_CHECK_EQUAL( all.kernel().served[ensemble<queue_kernel>::index(1, k - 1, k)], one.kernel().served[1]);
+}
+
+BOOST_AUTO_TEST_CASE( ensemble_diverged_lanes_match_separate_replications_test )
+{
+    //64 replications with times spread over hundreds of ticks, so the lanes rarely share a step, and jobs sent
+    //to the servers of all the lanes every 250 ticks, each lane ends as the same replication run alone
+    const size_t k = 64;
+    vector<uint32_t> seeds;
+    for (size_t l = 0; l < k; l++) seeds.push_back(static_cast<uint32_t>(3 + 104729 * l));
+    ensemble<queue_kernel> all{queue_kernel{k, seeds, 100}, k, {1}, {{0, 1}}, {1}};
+    run_with_input(all, Time(20000), Time(250));
+    size_t steps = all.kernel().internal_calls;
+    size_t alone = 0;
+    for (size_t l = 0; l < k; l++){
+        ensemble<queue_kernel> one{queue_kernel{1, {seeds[l]}, 100}, 1, {1}, {{0, 1}}, {1}};
+        run_with_input(one, Time(20000), Time(250));
+        BOOST_CHECK_EQUAL( all.kernel().served[ensemble<queue_kernel>::index(1, l, k)], one.kernel().served[1]);
+        BOOST_CHECK_EQUAL( all.kernel().queued[ensemble<queue_kernel>::index(1, l, k)], one.kernel().queued[1]);
+        alone += one.kernel().internal_calls;
+    }
+    BOOST_CHECK_GT( steps, alone / 2); //few steps are shared
+}
@@ -27,7 +27,9 @@
 
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/unit_test.hpp>
+#include <boost/simulation/fixed_time.hpp>
 #include <boost/simulation/pdevs/basic_models/generator.hpp>
+#include <boost/simulation/convenience.hpp>
 #include <boost/rational.hpp>
 #include <boost/any.hpp>
 
@@ -36,7 +38,7 @@ using namespace boost::simulation::pdevs;
 using namespace boost::simulation::pdevs::basic_models;
 using namespace std;
 
-using Time=boost::rational<int>;
+using Time=fixed_time<1>;
 using Message=boost::any;
 
 BOOST_AUTO_TEST_SUITE( p_generator_test_suite )
@@ -75,5 +77,23 @@ BOOST_AUTO_TEST_CASE( p_generator_output_value_test )
     }
 }
 
+BOOST_AUTO_TEST_CASE( p_generator_shared_parameters_test )
+{
+    //Create many generators sharing the same parameters
+    //Check all of them tick with the shared period and value, and the parameters are not copied
+    using shared_generator=generator<Time, Message, shared_parameters>;
+    auto p = make_parameters_ptr<shared_generator>(Time{3}, std::vector<Message>{7});
+    std::vector<shared_generator> gs;
+    for (int i=0; i < 100; i++){
+        gs.emplace_back(p);
+    }
+    BOOST_CHECK_EQUAL(p.use_count(), 101);
+    for (auto& g : gs){
+        BOOST_CHECK_EQUAL(boost::any_cast<int>(g.out()[0]), 7);
+        g.internal();
+        BOOST_CHECK_EQUAL(g.advance(), Time{3});
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
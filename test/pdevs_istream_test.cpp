@@ -30,8 +30,9 @@
 #include <iostream>
 #include <sstream>
 #include <boost/test/unit_test.hpp>
+#include <boost/simulation/fixed_time.hpp>
 #include <boost/any.hpp>
-#include <boost/simulation/pdevs/basic_models/istream.hpp>
+#include <boost/simulation/pdevs/basic_models/input_stream.hpp>
 #include <math.h>
 
 using namespace boost::simulation;
@@ -39,7 +40,7 @@ using namespace boost::simulation::pdevs;
 using namespace boost::simulation::pdevs::basic_models;
 using namespace std;
 
-using Time=double;
+using Time=fixed_time<1>;
 using Message=boost::any;
 
 BOOST_AUTO_TEST_SUITE( pistream_test_suite )
@@ -51,14 +52,14 @@ BOOST_AUTO_TEST_CASE( pistream_simple_of_single_events_test )
     shared_ptr<istringstream> piss{ new istringstream{} };
     piss->str("0 0");
     //init
-    istream<Time, Message, int, int> pf{piss, Time(0)};
+    input_stream<Time, Message, int, int> pf{piss, Time(0)};
     BOOST_CHECK_EQUAL(pf.advance(), Time(0));
 
     // only message
     BOOST_REQUIRE_EQUAL(pf.out().size(), 1);
     BOOST_CHECK_EQUAL(boost::any_cast<int>(pf.out()[0]), 0);
     pf.internal();
-    BOOST_CHECK( isinf(pf.advance()));
+    BOOST_CHECK( (pf.advance()).is_inf());
 }
 
 BOOST_AUTO_TEST_CASE( pistream_simple_of_multiple_events_test )
@@ -69,13 +70,13 @@ BOOST_AUTO_TEST_CASE( pistream_simple_of_multiple_events_test )
     shared_ptr<istringstream> piss{ new istringstream{} };
     piss->str("0 0 \n 0 1 \n 0 2 ");
     //init
-    istream<Time, Message, int, int> pf{piss, Time(0)};
+    input_stream<Time, Message, int, int> pf{piss, Time(0)};
     BOOST_CHECK_EQUAL(pf.advance(), Time(0));
 
     // only output
     BOOST_REQUIRE_EQUAL(pf.out().size(), 3);
     pf.internal();
-    BOOST_CHECK( isinf(pf.advance()));
+    BOOST_CHECK( (pf.advance()).is_inf());
 }
 
 
@@ -87,7 +88,7 @@ BOOST_AUTO_TEST_CASE( pistream_as_generator_of_single_events_test )
     shared_ptr<istringstream> piss{ new istringstream{} };
     piss->str("0 0 \n 1 1 \n 2 2 \n 3 3 \n 4 4 \n 5 5 \n 6 6 \n 7 7 \n 8 8 \n 9 9 \n 10 10");
     //init
-    istream<Time, Message, int, int> pf{piss, Time(0)};
+    input_stream<Time, Message, int, int> pf{piss, Time(0)};
     BOOST_CHECK_EQUAL(pf.advance(), Time(0));
 
     //consume
@@ -101,7 +102,7 @@ BOOST_AUTO_TEST_CASE( pistream_as_generator_of_single_events_test )
     BOOST_REQUIRE_EQUAL(pf.out().size(), 1);
     BOOST_CHECK_EQUAL(boost::any_cast<int>(pf.out()[0]), 10);
     pf.internal();
-    BOOST_CHECK( isinf(pf.advance()));
+    BOOST_CHECK( (pf.advance()).is_inf());
 }
 
 
@@ -113,7 +114,7 @@ BOOST_AUTO_TEST_CASE( pistream_as_generator_of_multiple_events_test )
     shared_ptr<istringstream> piss{ new istringstream{} };
     piss->str("1 1 \n 1 1 \n 2 2 \n 2 2 \n 3 3 \n 3 3 \n 4 4 \n 4 4 \n 5 5 \n 5 5");
     //init
-    istream<Time, Message, int, int> pf{piss, Time(0)};
+    input_stream<Time, Message, int, int> pf{piss, Time(0)};
     BOOST_CHECK_EQUAL(pf.advance(), Time(1));
     //advance simulation
     for (int i=1; i < 5; i++){
@@ -128,7 +129,7 @@ BOOST_AUTO_TEST_CASE( pistream_as_generator_of_multiple_events_test )
     BOOST_CHECK_EQUAL(boost::any_cast<int>(pf.out()[0]), 5);
     BOOST_CHECK_EQUAL(boost::any_cast<int>(pf.out()[1]), 5);
     pf.internal();
-    BOOST_CHECK( isinf(pf.advance()));
+    BOOST_CHECK( (pf.advance()).is_inf());
 }
 
 //custom processor of input
@@ -140,7 +141,7 @@ BOOST_AUTO_TEST_CASE( pistream_with_custom_processor_as_generator_of_multiple_ev
     shared_ptr<istringstream> piss{ new istringstream{} };
     piss->str("1 hello \n 1 world \n 2 hello \n 2 world");
     //init
-    istream<Time, Message, int, int> pf{piss, Time(0),
+    input_stream<Time, Message, int, int> pf{piss, Time(0),
                 [](const string& s, Time& t_next, boost::any& m_next)->void{
             //intermediary vars for casting
             int tmp_next;
@@ -168,7 +169,7 @@ BOOST_AUTO_TEST_CASE( pistream_with_custom_processor_as_generator_of_multiple_ev
     BOOST_CHECK(any_of(pf.out().begin(), pf.out().end(), [](const boost::any& m ){ string s = boost::any_cast<string>(m); return s.compare("hello")==0;}));
     BOOST_CHECK(any_of(pf.out().begin(), pf.out().end(), [](const boost::any& m ){ string s = boost::any_cast<string>(m); return s.compare("world")==0;}));
     pf.internal();
-    BOOST_CHECK( isinf(pf.advance()));
+    BOOST_CHECK( (pf.advance()).is_inf());
 }
 
 
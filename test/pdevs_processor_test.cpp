@@ -27,17 +27,19 @@
 
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/unit_test.hpp>
+#include <boost/simulation/fixed_time.hpp>
 #include <algorithm>
 #include <boost/rational.hpp>
 #include <boost/simulation/pdevs/basic_models/processor.hpp>
 #include <boost/simulation/pdevs/coordinator.hpp>
+#include <boost/simulation/convenience.hpp>
 #include <math.h>
 
 using namespace boost::simulation;
 using namespace boost::simulation::pdevs;
 using namespace boost::simulation::pdevs::basic_models;
 
-using Time=double;
+using Time=fixed_time<1>;
 using Message=int;
 
 BOOST_AUTO_TEST_SUITE( processor_test_suite )
@@ -51,12 +53,12 @@ BOOST_AUTO_TEST_CASE( processing_single_jobs_test )
     //check ta=passive and out=job was input
     for (int i=0; i<10; i++){
         processor<Time, Message> p{static_cast<Time>(i)};
-        BOOST_CHECK( isinf(p.advance()) );
+        BOOST_CHECK( (p.advance()).is_inf() );
         p.external({i}, Time{1});
         BOOST_CHECK_EQUAL(p.advance(), Time(i));
         BOOST_CHECK_EQUAL(boost::any_cast<int>(p.out()[0]), i);
         p.internal();
-        BOOST_CHECK( isinf(p.advance()));
+        BOOST_CHECK( (p.advance()).is_inf());
     }
 }
 BOOST_AUTO_TEST_CASE( processing_sequential_jobs_test )
@@ -70,14 +72,14 @@ BOOST_AUTO_TEST_CASE( processing_sequential_jobs_test )
     //check passive at the end of last job
     for (int i{0}; i<10; i++){
         processor<Time, Message> p{static_cast<Time>(i)};
-        BOOST_CHECK( isinf(p.advance()) );
+        BOOST_CHECK( (p.advance()).is_inf() );
 
         for (int j{0}; j <= i ; j++){
             p.external({j}, Time{1});
             BOOST_CHECK_EQUAL(p.advance(), Time(i));
             BOOST_CHECK_EQUAL(boost::any_cast<int>(p.out()[0]), j);
             p.internal();
-            BOOST_CHECK( isinf(p.advance()));
+            BOOST_CHECK( (p.advance()).is_inf());
         }
     }
 }
@@ -87,7 +89,7 @@ BOOST_AUTO_TEST_CASE( multiple_jobs_return_one_at_the_time_test )
     //input multiple jobs
     //obtain n separated jobs
     processor<Time, Message> p{Time{1}};
-    BOOST_CHECK( isinf(p.advance()) );
+    BOOST_CHECK( (p.advance()).is_inf() );
 
     p.external({1, 2, 3, 4}, Time{0});
     for (int i=0; i<4; i++){
@@ -95,8 +97,29 @@ BOOST_AUTO_TEST_CASE( multiple_jobs_return_one_at_the_time_test )
         BOOST_CHECK_EQUAL(p.out().size(), 1);
         p.internal();
     }
-    BOOST_CHECK( isinf(p.advance()));
+    BOOST_CHECK( (p.advance()).is_inf());
 
 }
+BOOST_AUTO_TEST_CASE( processors_sharing_parameters_keep_their_own_jobs_test )
+{
+    //create processors sharing the processing time.
+    //input different jobs to each
+    //check each outputs its own jobs with the shared processing time
+    using shared_processor=processor<Time, Message, shared_parameters>;
+    auto params = make_parameters_ptr<shared_processor>(Time{2});
+    shared_processor p{params};
+    shared_processor q{params};
+    p.external({1, 2}, Time{0});
+    q.external({3}, Time{0});
+    BOOST_CHECK_EQUAL(p.advance(), Time{2});
+    BOOST_CHECK_EQUAL(q.advance(), Time{2});
+    BOOST_CHECK_EQUAL(boost::any_cast<int>(p.out()[0]), 1);
+    BOOST_CHECK_EQUAL(boost::any_cast<int>(q.out()[0]), 3);
+    p.internal();
+    q.internal();
+    BOOST_CHECK_EQUAL(boost::any_cast<int>(p.out()[0]), 2);
+    BOOST_CHECK_EQUAL(p.advance(), Time{2});
+    BOOST_CHECK( (q.advance()).is_inf());
+}
 BOOST_AUTO_TEST_SUITE_END()
 
@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <boost/simulation/fixed_time.hpp>
+#include <boost/simulation/pdevs/coordinator.hpp>
+#include <boost/simulation/pdevs/prototype.hpp>
+#include <boost/simulation/pdevs/basic_models/generator.hpp>
+#include <boost/simulation/pdevs/basic_models/processor.hpp>
+#include <boost/simulation/convenience.hpp>
+
+using namespace boost::simulation;
+using namespace boost::simulation::pdevs;
+using namespace boost::simulation::pdevs::basic_models;
+
+using Time=fixed_time<1>;
+using Message=boost::any;
+
+BOOST_AUTO_TEST_SUITE( p_prototype_test_suite )
+
+BOOST_AUTO_TEST_CASE( cloned_atomic_copies_state_and_dispatch_test )
+{
+    auto pp = make_atomic_ptr<processor<Time, Message>, Time>(Time{2});
+    pp->external({Message{1}}, Time{0});
+    auto clone = pp->clone();
+    BOOST_REQUIRE( clone != nullptr);
+    BOOST_CHECK( clone != pp);
+    BOOST_CHECK( &clone->dispatch() == &pp->dispatch());
+    BOOST_CHECK_EQUAL( clone->advance(), pp->advance());
+    //the copies evolve independently
+    clone->internal();
+    BOOST_CHECK_EQUAL( pp->advance(), Time{2});
+    BOOST_CHECK( clone->advance() != Time{2});
+
+    //models of unknown type can not be cloned
+    std::shared_ptr<atomic<Time, Message>> pv{ new processor<Time, Message>{Time{2}} };
+    BOOST_CHECK( pv->clone() == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE( instances_simulate_as_the_prototype_test )
+{
+    //a generator sending to a processor, the processor connected to the output
+    auto build = [](){
+        auto pg = make_atomic_ptr<generator<Time, Message>, Time>(Time{3});
+        auto pp = make_atomic_ptr<processor<Time, Message>, Time>(Time{1});
+        return std::shared_ptr<coupled<Time, Message>>( new coupled<Time, Message>{{pg, pp}, {}, {{pg, pp}}, {pp}});
+    };
+    prototype<Time, Message> proto{build()};
+    BOOST_CHECK_EQUAL( proto.size(), 2);
+    auto instances = proto.instantiate(3);
+    BOOST_REQUIRE_EQUAL( instances.size(), 3);
+    BOOST_CHECK( instances[0]->get_flat_description().models[0] != instances[1]->get_flat_description().models[0]);
+
+    //three instances send three times the output of one model built by hand
+    std::vector<std::shared_ptr<model<Time>>> models(instances.begin(), instances.end());
+    auto cm = std::shared_ptr<coupled<Time, Message>>( new coupled<Time, Message>{models, {}, {}, models});
+    coordinator<Time, Message, priority_queue_vector> ci{cm};
+    coordinator<Time, Message, priority_queue_vector> cb{build()};
+    Time ti = ci.init(Time{0});
+    Time tb = cb.init(Time{0});
+    for (int i = 0; i < 10; i++){
+        BOOST_REQUIRE_EQUAL( ti, tb);
+        BOOST_CHECK_EQUAL( ci.step(ti).size(), 3 * cb.step(tb).size());
+        ti = ci.next();
+        tb = cb.next();
+    }
+}
+
+BOOST_AUTO_TEST_CASE( copied_coordinators_simulate_as_built_ones_test )
+{
+    //two generators sending through a relay to two processors, the processors connected to the output
+    auto build = [](){
+        auto pg1 = make_atomic_ptr<generator<Time, Message>, Time>(Time{2});
+        auto pg2 = make_atomic_ptr<generator<Time, Message>, Time>(Time{3});
+        auto pp1 = make_atomic_ptr<processor<Time, Message>, Time>(Time{1});
+        auto pp2 = make_atomic_ptr<processor<Time, Message>, Time>(Time{5});
+        std::shared_ptr<coupled<Time, Message>> gs( new coupled<Time, Message>{{pg1, pg2}, {}, {}, {pg1, pg2}});
+        std::shared_ptr<coupled<Time, Message>> ps( new coupled<Time, Message>{{pp1, pp2}, {pp1, pp2}, {}, {pp1, pp2}});
+        return std::shared_ptr<coupled<Time, Message>>( new coupled<Time, Message>{{gs, ps}, {}, {{gs, ps}}, {ps}});
+    };
+    using fel_coordinator=coordinator<Time, Message, priority_queue_vector>;
+    for (bool reorder : {false, true}){
+        prototype<Time, Message, fel_coordinator> proto{build(), reorder};
+        auto instances = proto.instantiate(2);
+        std::unique_ptr<fel_coordinator> c0 = proto.coordinate(instances[0]);
+        std::unique_ptr<fel_coordinator> c1 = proto.coordinate(instances[1]);
+        fel_coordinator cb{build(), 1, false, reorder};
+        Time t0 = c0->init(Time{0});
+        Time t1 = c1->init(Time{0});
+        Time tb = cb.init(Time{0});
+        for (int i = 0; i < 10; i++){
+            BOOST_REQUIRE_EQUAL( t0, tb);
+            BOOST_REQUIRE_EQUAL( t1, tb);
+            std::size_t out = cb.step(tb).size();
+            BOOST_CHECK_EQUAL( c0->step(t0).size(), out);
+            BOOST_CHECK_EQUAL( c1->step(t1).size(), out);
+            t0 = c0->next();
+            t1 = c1->next();
+            tb = cb.next();
+        }
+    }
+
+    //the polling coordinator is copied the same way
+    prototype<Time, Message> proto{build()};
+    auto cn = proto.coordinate(proto.instantiate());
+    coordinator<Time, Message> cb{build()};
+    Time tn = cn->init(Time{0});
+    Time tb = cb.init(Time{0});
+    for (int i = 0; i < 10; i++){
+        BOOST_REQUIRE_EQUAL( tn, tb);
+        BOOST_CHECK_EQUAL( cn->step(tn).size(), cb.step(tb).size());
+        tn = cn->next();
+        tb = cb.next();
+    }
+
+    //instances of another prototype do not fit
+    auto pg = make_atomic_ptr<generator<Time, Message>, Time>(Time{2});
+    prototype<Time, Message> other{std::shared_ptr<coupled<Time, Message>>( new coupled<Time, Message>{{pg}, {}, {}, {pg}})};
+    BOOST_CHECK_THROW( proto.coordinate(other.instantiate()), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( prototypes_reject_models_that_can_not_be_cloned_test )
+{
+    //models built with new run with virtual dispatch, their type is unknown and they can not be cloned
+    std::shared_ptr<atomic<Time, Message>> pg{ new generator<Time, Message>{Time{3}} };
+    auto pp = make_atomic_ptr<processor<Time, Message>, Time>(Time{1});
+    std::shared_ptr<coupled<Time, Message>> cm( new coupled<Time, Message>{{pg, pp}, {}, {{pg, pp}}, {pp}});
+    using prototype_type=prototype<Time, Message>;
+    BOOST_CHECK_THROW( prototype_type{cm}, std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
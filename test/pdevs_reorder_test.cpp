@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <boost/simulation/pdevs/reorder.hpp>
+
+using namespace boost::simulation::pdevs;
+using namespace std;
+
+using edges=vector<pair<uint32_t, uint32_t>>;
+
+namespace {
+//largest distance between the positions of two connected vertices
+size_t bandwidth(const vector<uint32_t>& order, const edges& es){
+    vector<size_t> position(order.size());
+    for (size_t k = 0; k < order.size(); k++) position[order[k]] = k;
+    size_t band = 0;
+    for (auto& e : es){
+        size_t a = position[e.first], b = position[e.second];
+        band = max(band, a > b ? a - b : b - a);
+    }
+    return band;
+}
+}
+
+BOOST_AUTO_TEST_CASE( reverse_cuthill_mckee_returns_a_permutation_test )
+{
+    mt19937 gen(42);
+    edges es;
+    for (int i = 0; i < 300; i++) es.emplace_back(gen() % 100, gen() % 100); //self loops and repeated edges included
+    auto order = reverse_cuthill_mckee(120, es); //vertices from 100 have no edges
+    BOOST_REQUIRE_EQUAL( order.size(), 120u);
+    sort(order.begin(), order.end());
+    for (uint32_t v = 0; v < 120; v++) BOOST_CHECK_EQUAL( order[v], v);
+    BOOST_CHECK( reverse_cuthill_mckee(0, edges{}).empty());
+}
+
+BOOST_AUTO_TEST_CASE( reverse_cuthill_mckee_places_neighbours_close_test )
+{
+    //a path and a 20x20 grid with their vertices numbered at random
+    mt19937 gen(42);
+    vector<uint32_t> label(400);
+    for (uint32_t v = 0; v < 400; v++) label[v] = v;
+    shuffle(label.begin(), label.end(), gen);
+    edges path, grid;
+    for (uint32_t v = 1; v < 400; v++) path.emplace_back(label[v - 1], label[v]);
+    for (uint32_t r = 0; r < 20; r++){
+        for (uint32_t c = 0; c < 20; c++){
+            if (c > 0) grid.emplace_back(label[r * 20 + c - 1], label[r * 20 + c]);
+            if (r > 0) grid.emplace_back(label[(r - 1) * 20 + c], label[r * 20 + c]);
+        }
+    }
+    vector<uint32_t> identity(400);
+    for (uint32_t v = 0; v < 400; v++) identity[v] = v;
+    BOOST_CHECK_EQUAL( bandwidth(reverse_cuthill_mckee(400, path), path), 1u);
+    BOOST_CHECK_LE( bandwidth(reverse_cuthill_mckee(400, grid), grid), 21u);
+    BOOST_CHECK_GT( bandwidth(identity, grid), 200u);
+}
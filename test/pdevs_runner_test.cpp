@@ -26,11 +26,14 @@
 
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/unit_test.hpp>
+#include <boost/simulation/fixed_time.hpp>
 #include <algorithm>
+#include <thread>
 #include <boost/rational.hpp>
 #include <boost/simulation/pdevs/runner.hpp>
+#include <boost/simulation/pdevs/observers.hpp>
 #include <boost/simulation/pdevs/basic_models/generator.hpp>
-#include <boost/simulation/pdevs/basic_models/istream.hpp>
+#include <boost/simulation/pdevs/basic_models/input_stream.hpp>
 #include <math.h>
 
 using namespace boost::simulation;
@@ -38,7 +41,7 @@ using namespace boost::simulation::pdevs;
 using namespace boost::simulation::pdevs::basic_models;
 using namespace std;
 
-using Time=double;
+using Time=fixed_time<1>;
 using Message=boost::any;
 
 BOOST_AUTO_TEST_SUITE( p_runner_for_pdevs_test_suite )
@@ -64,19 +67,19 @@ BOOST_AUTO_TEST_CASE( p_runner_stops_on_passive_test )
     {
         shared_ptr<istringstream> piss{ new istringstream{} };
         piss->str("1 1 \n 4 4 \n 5 5 \n 6 6 \n 8 8 \n 9 9 ");
-        shared_ptr<pdevs::atomic<Time, Message>> pf{ new istream<Time, Message, int, int>{piss, Time{0}}};
+        shared_ptr<pdevs::atomic<Time, Message>> pf{ new input_stream<Time, Message, int, int>{piss, Time{0}}};
 
         shared_ptr<coupled<Time, Message>> cm( new coupled<Time, Message>{{pf}, {}, {}, {pf}});
         runner<Time, Message> r(cm, Time{0});
 
-        BOOST_CHECK( isinf(r.runUntil(Time{20})));
+        BOOST_CHECK( (r.runUntil(Time{20})).is_inf());
     }
     //repeat to stop in middle of the fixed events list
     //check it ends in last event before limit and returns the next
     {
         shared_ptr<istringstream> piss{ new istringstream{} };
         piss->str("1 1 \n 4 4 \n 5 5 \n 6 6 \n 8 8 \n 9 9 ");
-        shared_ptr<pdevs::atomic<Time, Message>> pf{ new istream<Time, Message, int, int>{piss, Time{0}}};
+        shared_ptr<pdevs::atomic<Time, Message>> pf{ new input_stream<Time, Message, int, int>{piss, Time{0}}};
 
         shared_ptr<coupled<Time, Message>> cm( new coupled<Time, Message>{{pf}, {}, {}, {pf}});
         runner<Time, Message> r(cm, Time{0});
@@ -93,7 +96,7 @@ BOOST_AUTO_TEST_CASE( p_runner_until_passive_test )
     {
         shared_ptr<istringstream> piss{ new istringstream{} };
         piss->str("1 1 \n 4 4 \n 5 5 \n 6 6 \n 8 8 \n 9 9 ");
-        shared_ptr<pdevs::atomic<Time, Message>> pf{ new istream<Time, Message, int, int>{piss, Time{0}}};
+        shared_ptr<pdevs::atomic<Time, Message>> pf{ new input_stream<Time, Message, int, int>{piss, Time{0}}};
 
         shared_ptr<coupled<Time, Message>> cm( new coupled<Time, Message>{{pf}, {}, {}, {pf}});
         runner<Time, Message> r(cm, Time{0});
@@ -134,7 +137,7 @@ BOOST_AUTO_TEST_CASE( p_runner_runs_generator_until_10sec_test )
         BOOST_CHECK_EQUAL( s_out,
                            "1 1\n2 1\n3 1\n4 1\n5 1\n6 1\n7 1\n8 1\n9 1\n"
                            );
-    } else if (is_same<Time, double>()){
+    } else if (is_same<Time, double>() || is_same<Time, fixed_time<1>>()){
         BOOST_CHECK_EQUAL( s_out,
                            "1 1\n2 1\n3 1\n4 1\n5 1\n6 1\n7 1\n8 1\n9 1\n"
                            );
@@ -149,7 +152,7 @@ BOOST_AUTO_TEST_CASE( p_runner_runs_generator_until_passivate_test )
     //run until passivate and check the output.
     shared_ptr<istringstream> piss{ new istringstream{} };
     piss->str("1 1 \n 4 4 \n 5 5 \n 6 6 \n 8 8 \n 9 9 ");
-    shared_ptr<pdevs::atomic<Time, Message>> pf{ new istream<Time, Message, int, int>{piss, Time{0}}};
+    shared_ptr<pdevs::atomic<Time, Message>> pf{ new input_stream<Time, Message, int, int>{piss, Time{0}}};
 
     shared_ptr<coupled<Time, Message>> cm( new coupled<Time, Message>{{pf}, {}, {}, {pf}});
 
@@ -173,7 +176,7 @@ BOOST_AUTO_TEST_CASE( p_runner_runs_generator_until_passivate_test )
         BOOST_CHECK_EQUAL( s_out,
                            "1 1\n4 4\n5 5\n6 6\n8 8\n9 9\n"
                            );
-    } else if (is_same<Time, double>()){
+    } else if (is_same<Time, double>() || is_same<Time, fixed_time<1>>()){
         BOOST_CHECK_EQUAL( s_out,
                            "1 1\n4 4\n5 5\n6 6\n8 8\n9 9\n"
                            );
@@ -183,5 +186,56 @@ BOOST_AUTO_TEST_CASE( p_runner_runs_generator_until_passivate_test )
 }
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_AUTO_TEST_SUITE( p_runner_with_observer_test_suite )
+
+BOOST_AUTO_TEST_CASE( p_runner_counts_generator_transitions_test )
+{
+    //create a generator with tick 1, embed it in a coupled and create the p_runner with a counting observer
+    //run until 10, when it ends, check the counters.
+    shared_ptr<pdevs::atomic<Time, Message>> pa{ new generator<Time, Message>{Time{1}} };
+    shared_ptr<coupled<Time, Message>> cm( new coupled<Time, Message>{{pa}, {}, {}, {pa}});
+
+    using counter=counting_observer<Time, Message>;
+    counter::reset();
+    ostringstream oss;
+    runner<Time, Message, nullqueue, counting_observer> r(cm, Time{0}, oss, [](ostream& os, boost::any m){ os << boost::any_cast<int>(m);});
+
+    r.runUntil(Time{10});
+
+    BOOST_CHECK_EQUAL( counter::counters.internals, 9);
+    BOOST_CHECK_EQUAL( counter::counters.externals, 0);
+    BOOST_CHECK_EQUAL( counter::counters.outputs, 9);
+    BOOST_CHECK_EQUAL( counter::counters.routes, 0);
+}
+
+BOOST_AUTO_TEST_CASE( p_runner_counts_each_run_apart_test )
+{
+    //run the same model twice with a counting observer, and a third time in another thread
+    //check the runs do not count the events of the others.
+    shared_ptr<pdevs::atomic<Time, Message>> pa{ new generator<Time, Message>{Time{1}} };
+    shared_ptr<coupled<Time, Message>> cm( new coupled<Time, Message>{{pa}, {}, {}, {pa}});
+
+    using counter=counting_observer<Time, Message>;
+    runner<Time, Message, nullqueue, counting_observer> r1(cm, Time{0});
+    r1.runUntil(Time{5});
+    BOOST_CHECK_EQUAL( counter::counters.internals, 4);
+
+    std::size_t other = 0;
+    std::thread th([&other](){
+        shared_ptr<pdevs::atomic<Time, Message>> pb{ new generator<Time, Message>{Time{1}} };
+        shared_ptr<coupled<Time, Message>> cmb( new coupled<Time, Message>{{pb}, {}, {}, {pb}});
+        runner<Time, Message, nullqueue, counting_observer> r(cmb, Time{0});
+        r.runUntil(Time{3});
+        other = counter::counters.internals;
+    });
+    th.join();
+    BOOST_CHECK_EQUAL( other, 2);
+    BOOST_CHECK_EQUAL( counter::counters.internals, 4);
+
+    runner<Time, Message, nullqueue, counting_observer> r2(cm, Time{0});
+    BOOST_CHECK_EQUAL( counter::counters.internals, 0);
+}
+BOOST_AUTO_TEST_SUITE_END()
+
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <random>
+#include <limits>
+#include <boost/simulation/fixed_time.hpp>
+#include <boost/simulation/pdevs/simd.hpp>
+
+using namespace boost::simulation;
+using namespace boost::simulation::pdevs;
+using namespace std;
+
+using Time=fixed_time<1000>;
+
+namespace {
+//random times with many repetitions, some of them infinity, for every length up to 40
+//checks the kernels selected for TIME give the same results than the scalar loops
+template<class TIME, class MAKE>
+void check_kernels(MAKE make, TIME infinity){
+    mt19937_64 gen(42);
+    for (size_t n = 0; n <= 40; n++){
+        for (int round = 0; round < 20; round++){
+            vector<TIME> times;
+            for (size_t i = 0; i < n; i++){
+                times.push_back(gen() % 5 == 0 ? infinity : make(gen() % 8));
+            }
+            TIME scalar = infinity;
+            for (auto& t : times) if (t < scalar) scalar = t;
+            TIME vectorized = min_time(times.data(), times.size(), infinity);
+            BOOST_CHECK(vectorized == scalar);
+            BOOST_CHECK(min_time(times.data(), times.size(), make(0)) == make(0));
+
+            TIME value = make(gen() % 8);
+            vector<size_t> expected, visited;
+            for (size_t i = 0; i < n; i++) if (times[i] == value) expected.push_back(i);
+            for_each_equal(times.data(), times.size(), value, [&visited](size_t i){ visited.push_back(i); });
+            BOOST_CHECK(visited == expected);
+        }
+    }
+}
+}
+
+BOOST_AUTO_TEST_CASE( simd_kernels_match_scalar_loops_test )
+{
+    check_kernels<double>([](uint64_t v){ return static_cast<double>(v) / 4; }, numeric_limits<double>::infinity());
+    check_kernels<int64_t>([](uint64_t v){ return static_cast<int64_t>(v) - 3; }, numeric_limits<int64_t>::max());
+    check_kernels<Time>([](uint64_t v){ return Time::from_ticks(static_cast<int64_t>(v) - 3); }, Time::Inf());
+    check_kernels<float>([](uint64_t v){ return static_cast<float>(v); }, numeric_limits<float>::infinity());
+}
@@ -26,10 +26,11 @@
 
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/unit_test.hpp>
+#include <boost/simulation/fixed_time.hpp>
 #include <boost/simulation/pdevs/coordinator.hpp>
 #include <boost/simulation/pdevs/basic_models/infinite_counter.hpp>
 #include <boost/simulation/pdevs/basic_models/generator.hpp>
-#include <boost/simulation/pdevs/basic_models/istream.hpp>
+#include <boost/simulation/pdevs/basic_models/input_stream.hpp>
 #include <math.h>
 #include <boost/simulation/convenience.hpp>
 
@@ -39,7 +40,7 @@ using namespace boost::simulation::pdevs;
 using namespace boost::simulation::pdevs::basic_models;
 using namespace std;
 
-using Time=double;
+using Time=fixed_time<1>;
 using Message=boost::any;
 
 /**
@@ -87,6 +88,28 @@ BOOST_AUTO_TEST_CASE( simulated_generator_in_coupled_init_test )
     }
 
 }
+BOOST_AUTO_TEST_CASE( simulated_generator_devirtualized_test )
+{
+    //Create a generator using make_atomic_ptr and another one using new
+    //check the first is run without virtual calls and both produce the same simulation
+    auto pa = make_atomic_ptr<generator<Time, Message>, Time>(Time{1});
+    std::shared_ptr<pdevs::atomic<Time, Message>> pb{ new generator<Time, Message>{Time{1}} };
+    BOOST_CHECK(( &pa->dispatch() == &typed_dispatch<generator<Time, Message>>::table ));
+    BOOST_CHECK(( &pb->dispatch() == &virtual_dispatch<Time, Message>::table ));
+    //copies do not keep the dispatch of the original, the copy could be of a derived type
+    std::shared_ptr<pdevs::atomic<Time, Message>> pc{ new generator<Time, Message>{static_cast<const generator<Time, Message>&>(*pa)} };
+    BOOST_CHECK(( &pc->dispatch() == &virtual_dispatch<Time, Message>::table ));
+    BOOST_CHECK(( &pa->clone()->dispatch() == &typed_dispatch<generator<Time, Message>>::table ));
+
+    coordinator<Time, Message> sa{pa};
+    coordinator<Time, Message> sb{pb};
+    BOOST_CHECK_EQUAL( sa.init(Time(0)), sb.init(Time(0)));
+    BOOST_CHECK_EQUAL( sa.collectOutputs(Time{1}).size(), sb.collectOutputs(Time{1}).size());
+    sa.advanceSimulation(Time{1});
+    sb.advanceSimulation(Time{1});
+    BOOST_CHECK_EQUAL( sa.next(), Time{2});
+    BOOST_CHECK_EQUAL( sb.next(), Time{2});
+}
 BOOST_AUTO_TEST_SUITE_END()
 //pinfinite_counter based tests
 BOOST_AUTO_TEST_SUITE( p_simulated_infinite_counter_test_suite )
@@ -98,7 +121,7 @@ BOOST_AUTO_TEST_CASE( simulated_infinite_counter_init_test )
     {
         auto pa = make_atomic_ptr<infinite_counter<Time, Message>>();
         coordinator<Time, Message> s{pa};
-        BOOST_CHECK( isinf(s.init(Time(0))));
+        BOOST_CHECK( (s.init(Time(0))).is_inf());
     }
 }
 BOOST_AUTO_TEST_CASE( simulated_infinite_counter_advance_external_internal_test )
@@ -110,7 +133,7 @@ BOOST_AUTO_TEST_CASE( simulated_infinite_counter_advance_external_internal_test
         auto pa = make_atomic_ptr<infinite_counter<Time, Message>>();
         std::shared_ptr<std::istringstream> piss{ new std::istringstream{} };
         piss->str("1 1 \n 1 2 \n 1 3 \n 1 4 \n 2 5 \n 2 6 \n 2 7 \n 2 8 \n 2 0 ");
-        auto pf = make_atomic_ptr<istream<Time, Message, int, int>>(piss, Time(0));
+        auto pf = make_atomic_ptr<input_stream<Time, Message, int, int>>(piss, Time(0));
 
         auto pc = std::shared_ptr<coupled<Time, Message>>(new coupled<Time, Message>{{pf, pa}, {}, {{pf, pa}}, {pa}});
 
@@ -135,7 +158,7 @@ BOOST_AUTO_TEST_CASE( simulated_infinite_counter_advance_external_internal_test
         s.advanceSimulation( Time{2});
         BOOST_REQUIRE_EQUAL(reply.size(), 1);
         BOOST_CHECK_EQUAL(boost::any_cast<int>(reply[0]), 8);
-        BOOST_CHECK(isinf(s.next()));
+        BOOST_CHECK((s.next()).is_inf());
     }
 }
 BOOST_AUTO_TEST_CASE( simulated_infinite_counter_advance_confluenced_test )
@@ -148,7 +171,7 @@ BOOST_AUTO_TEST_CASE( simulated_infinite_counter_advance_confluenced_test )
         auto pa = make_atomic_ptr<infinite_counter<Time, Message>>();
         std::shared_ptr<std::istringstream> piss{ new std::istringstream{} };
         piss->str("1 1 \n 1 2 \n 1 3 \n 1 4 \n 1 0 \n 2 5 \n 2 6 \n 2 7 \n 2 8 \n 2 0 ");
-        auto pf = make_atomic_ptr<istream<Time, Message, int, int>, std::shared_ptr<std::istringstream>, Time>(piss, Time(0));
+        auto pf = make_atomic_ptr<input_stream<Time, Message, int, int>, std::shared_ptr<std::istringstream>, Time>(piss, Time(0));
 
         auto pc = std::shared_ptr<coupled<Time, Message>>(new coupled<Time, Message>{{pf, pa}, {}, {{pf, pa}}, {pa}});
 
@@ -181,7 +204,7 @@ BOOST_AUTO_TEST_CASE( simulated_infinite_counter_advance_confluenced_test )
         BOOST_CHECK_EQUAL(boost::any_cast<int>(reply[0]), 4);
 
         s.advanceSimulation( Time{2});
-        BOOST_CHECK(isinf(s.next()));
+        BOOST_CHECK((s.next()).is_inf());
     }
 }
 BOOST_AUTO_TEST_SUITE_END()
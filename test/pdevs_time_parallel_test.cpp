@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <sstream>
+#include <memory>
+#include <boost/simulation/fixed_time.hpp>
+#include <boost/simulation/convenience.hpp>
+#include <boost/simulation/pdevs/runner.hpp>
+#include <boost/simulation/pdevs/time_parallel.hpp>
+#include <boost/simulation/pdevs/basic_models/event_stream.hpp>
+#include <boost/simulation/pdevs/basic_models/processor.hpp>
+#include <boost/simulation/pdevs/basic_models/generator.hpp>
+
+using namespace boost::simulation;
+using namespace boost::simulation::pdevs;
+using namespace boost::simulation::pdevs::basic_models;
+using namespace std;
+
+using Time=fixed_time<1>;
+using Message=int;
+
+namespace {
+//bursts of jobs separated by idle periods, processed in 2 units of time each
+const int trace[][2] = {{1, 1}, {2, 2}, {3, 3}, {20, 4}, {21, 5}, {40, 6}, {41, 7}, {42, 8}, {43, 9}, {60, 10}};
+
+//the queue fed by the trace from start, guessed idle
+shared_ptr<coupled<Time, Message>> idle_queue(const Time& start){
+    shared_ptr<stringstream> pss{ new stringstream{} };
+    for (auto& job : trace){
+        if (Time{job[0]} >= start) *pss << job[0] << " " << job[1] << "\n";
+    }
+    auto source = make_atomic_ptr<event_stream<Time, Message>>(static_pointer_cast<std::istream>(pss), start);
+    auto server = make_atomic_ptr<processor<Time, Message>>(Time{2});
+    return make_shared<coupled<Time, Message>>(vector<shared_ptr<model<Time>>>{source, server},
+        vector<shared_ptr<model<Time>>>{}, vector<pair<shared_ptr<model<Time>>, shared_ptr<model<Time>>>>{{source, server}},
+        vector<shared_ptr<model<Time>>>{server});
+}
+
+void print(ostream& os, Message m){ os << m; }
+
+string sequential(shared_ptr<coupled<Time, Message>> c, const Time& end){
+    ostringstream oss;
+    runner<Time, Message> r(c, Time{0}, oss, print);
+    r.runUntil(end);
+    return oss.str();
+}
+}
+
+BOOST_AUTO_TEST_SUITE( time_parallel_test_suite )
+
+BOOST_AUTO_TEST_CASE( segments_starting_idle_run_once_test )
+{
+    //boundaries in the idle periods, the guesses are right
+    ostringstream oss;
+    time_parallel<Time, Message> tp(idle_queue, {Time{0}, Time{15}, Time{35}, Time{55}, Time{80}}, oss, print, 2);
+    BOOST_CHECK( tp.run().is_inf() );
+    BOOST_CHECK_EQUAL( tp.passes(), 1u );
+    BOOST_CHECK_EQUAL( tp.reruns(), 0u );
+    BOOST_CHECK_EQUAL( oss.str(), sequential(idle_queue(Time{0}), Time{80}) );
+}
+
+BOOST_AUTO_TEST_CASE( segments_starting_busy_are_fixed_test )
+{
+    //boundaries in the bursts, the queue is not idle at 4 and 42, the segments starting there are re-run
+    ostringstream oss;
+    time_parallel<Time, Message> tp(idle_queue, {Time{0}, Time{4}, Time{15}, Time{42}, Time{80}}, oss, print, 2);
+    tp.run();
+    BOOST_CHECK_EQUAL( tp.passes(), 2u );
+    BOOST_CHECK_EQUAL( tp.reruns(), 2u );
+    BOOST_CHECK_EQUAL( oss.str(), sequential(idle_queue(Time{0}), Time{80}) );
+}
+
+BOOST_AUTO_TEST_CASE( models_without_equal_state_run_sequentially_test )
+{
+    //generators do not compare their state, every guess is re-run until continued from the right one
+    auto ticking = [](const Time&){
+        auto g = make_atomic_ptr<generator<Time, Message>>(Time{3}, 7);
+        return make_shared<coupled<Time, Message>>(vector<shared_ptr<model<Time>>>{g}, vector<shared_ptr<model<Time>>>{},
+            vector<pair<shared_ptr<model<Time>>, shared_ptr<model<Time>>>>{}, vector<shared_ptr<model<Time>>>{g});
+    };
+    ostringstream oss;
+    time_parallel<Time, Message> tp(ticking, {Time{0}, Time{10}, Time{20}, Time{30}, Time{40}}, oss, print);
+    BOOST_CHECK_EQUAL( tp.run(), Time{42} );
+    BOOST_CHECK_EQUAL( tp.passes(), 4u );
+    BOOST_CHECK_EQUAL( tp.reruns(), 6u );
+    BOOST_CHECK_EQUAL( oss.str(), sequential(ticking(Time{0}), Time{40}) );
+}
+
+BOOST_AUTO_TEST_CASE( models_that_can_not_be_cloned_are_rejected_test )
+{
+    //models built with new can not be copied to compare the boundaries
+    auto by_new = [](const Time&){
+        shared_ptr<pdevs::atomic<Time, Message>> g{ new generator<Time, Message>{Time{3}, 7} };
+        return make_shared<coupled<Time, Message>>(vector<shared_ptr<model<Time>>>{g}, vector<shared_ptr<model<Time>>>{},
+            vector<pair<shared_ptr<model<Time>>, shared_ptr<model<Time>>>>{}, vector<shared_ptr<model<Time>>>{g});
+    };
+    time_parallel<Time, Message> tp(by_new, {Time{0}, Time{10}, Time{20}}, 2);
+    BOOST_CHECK_THROW( tp.run(), std::invalid_argument );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2013-2015, Damian Vicino
+ * Carleton University, Universite de Nice-Sophia Antipolis
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <queue>
+#include <random>
+#include <boost/simulation/fixed_time.hpp>
+#include <boost/simulation/pdevs/coordinator.hpp>
+#include <boost/simulation/pdevs/fel/timing_wheel.hpp>
+#include <boost/simulation/pdevs/basic_models/generator.hpp>
+#include <boost/simulation/convenience.hpp>
+
+using namespace boost::simulation;
+using namespace boost::simulation::pdevs;
+using namespace boost::simulation::pdevs::basic_models;
+using namespace std;
+
+using Time=fixed_time<1000>;
+using Message=int;
+
+BOOST_AUTO_TEST_SUITE( timing_wheel_test_suite )
+
+BOOST_AUTO_TEST_CASE( timing_wheel_orders_as_priority_queue_test )
+{
+    //schedule random events at short and long horizons, never before the top
+    //check events come out in the same time order than from a priority_queue
+    using item=pair<Time, int>;
+    using comp=bool(*)(const item&, const item&);
+    comp later = [](const item& lhs, const item& rhs){ return lhs.first > rhs.first; };
+    timing_wheel<item, comp> wheel(later);
+    priority_queue_vector<item, comp> queue(later);
+
+    mt19937_64 gen(42);
+    Time now{0};
+    for (int i = 0; i < 10000; i++){
+        if (queue.empty() || gen() % 3 != 0){
+            int64_t horizon = (i % 2 ? 1000 : int64_t(1) << 40);
+            Time t = now + Time::from_ticks(gen() % horizon);
+            wheel.emplace(t, i);
+            queue.emplace(t, i);
+        } else {
+            BOOST_REQUIRE( wheel.top().first == queue.top().first);
+            now = wheel.top().first;
+            wheel.pop();
+            queue.pop();
+        }
+        BOOST_REQUIRE_EQUAL( wheel.size(), queue.size());
+    }
+    while (!queue.empty()){
+        BOOST_REQUIRE( wheel.top().first == queue.top().first);
+        wheel.pop();
+        queue.pop();
+    }
+    BOOST_CHECK( wheel.empty());
+}
+
+BOOST_AUTO_TEST_CASE( timing_wheel_coordinated_generators_test )
+{
+    //create 3 generators with different periods, coordinate them using the timing_wheel
+    //check the next times and outputs are the ones of the priority_queue_vector coordinator.
+    auto pa1 = make_atomic_ptr<generator<Time, Message>, Time, Message>(Time{1}, 1);
+    auto pa2 = make_atomic_ptr<generator<Time, Message>, Time, Message>(Time{0.3}, 2);
+    auto pa3 = make_atomic_ptr<generator<Time, Message>, Time, Message>(Time{300}, 3);
+    auto cm = std::shared_ptr<coupled<Time, Message>>(new coupled<Time, Message>{{pa1, pa2, pa3}, {}, {}, {pa1, pa2, pa3}});
+
+    coordinator<Time, Message, timing_wheel> cw{cm};
+    coordinator<Time, Message, priority_queue_vector> cq{cm};
+    Time tw = cw.init(Time{0});
+    Time tq = cq.init(Time{0});
+    while (tq < Time{600}){
+        BOOST_REQUIRE( tw == tq);
+        auto rw = cw.step(tw);
+        auto rq = cq.step(tq);
+        BOOST_REQUIRE_EQUAL( rw.size(), rq.size());
+        BOOST_CHECK( is_permutation(rw.begin(), rw.end(), rq.begin()));
+        tw = cw.next();
+        tq = cq.next();
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()